@@ -0,0 +1,139 @@
+//
+//  Checkpoint.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/2/22.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include "Checkpoint.h"
+#include "Serialization.h"
+#include "Logger.h"
+using namespace std;
+
+struct CheckpointHeader{
+    char magic[8]; // "PSCKPT\0\0"
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t payloadBytes;
+    uint64_t checksum; // fnv1a of the payload
+};
+
+static const char checkpoint_magic[8] = {'P', 'S', 'C', 'K', 'P', 'T', 0, 0};
+
+void capture_globals(Checkpoint &checkpoint){
+    checkpoint.T = T;
+    checkpoint.dt = dt;
+    checkpoint.breathing = breathing;
+}
+
+void restore_globals(const Checkpoint &checkpoint){
+    T = checkpoint.T;
+    dt = checkpoint.dt;
+    breathing = checkpoint.breathing;
+}
+
+bool save_checkpoint(const char* filename, const Checkpoint &checkpoint){
+    BinaryWriter out;
+    out.bytes.resize(sizeof(CheckpointHeader));
+    out.Write(checkpoint.T);
+    out.Write(checkpoint.dt);
+    out.Write((uint8_t)checkpoint.breathing);
+    for (int i=0; i<4; i++){
+        out.Write(checkpoint.rng.s[i]);
+    }
+    write_robot(out, checkpoint.robot);
+    write_controller(out, checkpoint.control);
+    out.Write((int64_t)checkpoint.generation);
+    out.Write((uint32_t)checkpoint.population.size());
+    for (int r=0; r<checkpoint.population.size(); r++){
+        write_robot(out, checkpoint.population[r]);
+    }
+    out.Write((uint32_t)checkpoint.controllers.size());
+    for (int r=0; r<checkpoint.controllers.size(); r++){
+        write_controller(out, checkpoint.controllers[r]);
+    }
+
+    CheckpointHeader header;
+    memcpy(header.magic, checkpoint_magic, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.reserved = 0;
+    header.payloadBytes = out.bytes.size() - sizeof(CheckpointHeader);
+    header.checksum = fnv1a(out.bytes.data() + sizeof(CheckpointHeader), header.payloadBytes);
+    memcpy(out.bytes.data(), &header, sizeof(header));
+
+    return write_file_atomically(filename, out.bytes);
+}
+
+bool load_checkpoint(const char* filename, Checkpoint &checkpoint){
+    vector<char> bytes;
+    if (!read_file(filename, bytes)){
+        return false;
+    }
+
+    CheckpointHeader header;
+    if (bytes.size() < sizeof(header)){
+        LOG_ERROR(filename << " is too short to be a checkpoint");
+        return false;
+    }
+    memcpy(&header, bytes.data(), sizeof(header));
+    if (memcmp(header.magic, checkpoint_magic, sizeof(header.magic)) != 0){
+        LOG_ERROR(filename << " is not a checkpoint");
+        return false;
+    }
+    if (header.version > CHECKPOINT_VERSION){
+        LOG_ERROR(filename << " is checkpoint version " << header.version << ", this build reads up to " << CHECKPOINT_VERSION);
+        return false;
+    }
+    const char* payload = bytes.data() + sizeof(header);
+    if (header.payloadBytes != bytes.size() - sizeof(header) || fnv1a(payload, header.payloadBytes) != header.checksum){
+        LOG_ERROR(filename << " is truncated or corrupt");
+        return false;
+    }
+
+    //read into a scratch copy so a bad file leaves the caller's state untouched
+    Checkpoint loaded;
+    BinaryReader in(payload, header.payloadBytes);
+    uint8_t breathing_flag = 0;
+    in.Read(loaded.T);
+    in.Read(loaded.dt);
+    in.Read(breathing_flag);
+    loaded.breathing = breathing_flag != 0;
+    for (int i=0; i<4; i++){
+        in.Read(loaded.rng.s[i]);
+    }
+    read_robot(in, loaded.robot);
+    read_controller(in, loaded.control);
+    int64_t generation = 0;
+    in.Read(generation);
+    loaded.generation = generation;
+    uint32_t count = 0;
+    in.Read(count);
+    if (in.ok && count <= in.Remaining()){
+        loaded.population.resize(count);
+        for (int r=0; r<count && in.ok; r++){
+            read_robot(in, loaded.population[r]);
+        }
+    }
+    else{
+        in.ok = false;
+    }
+    in.Read(count);
+    if (in.ok && count <= in.Remaining()){
+        loaded.controllers.resize(count);
+        for (int r=0; r<count && in.ok; r++){
+            read_controller(in, loaded.controllers[r]);
+        }
+    }
+    else{
+        in.ok = false;
+    }
+
+    if (!in.ok || in.Remaining() != 0){
+        LOG_ERROR(filename << " does not match the checkpoint layout");
+        return false;
+    }
+    checkpoint = loaded;
+    return true;
+}
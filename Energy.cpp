@@ -0,0 +1,41 @@
+//
+//  Energy.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/5/22.
+//
+
+#include <stdio.h>
+#include <math.h>
+#include "Energy.h"
+using namespace std;
+
+EnergyLog::EnergyLog(int capacity, int interval)
+{
+    EnergyLog::interval = max(interval, 1);
+    samples.resize(max(capacity, 1));
+    next = 0;
+    count = 0;
+}
+
+EnergySample* EnergyLog::Sample(long step)
+{
+    if (step % interval != 0){
+        return NULL;
+    }
+    EnergySample &sample = samples[next];
+    sample.step = step;
+    next = (next + 1) % samples.size();
+    count = min(count + 1, samples.size());
+    return &sample;
+}
+
+float EnergyLog::Drift() const
+{
+    if (count < 2){
+        return 0;
+    }
+    float first = (*this)[0].Total();
+    float last = Newest().Total();
+    return (last - first)/max(fabsf(first), 1e-6f);
+}
@@ -0,0 +1,120 @@
+//
+//  FrameWriter.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/18/21.
+//
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include "FrameWriter.h"
+#include "Logger.h"
+using namespace std;
+
+static bool write_ppm(FILE* out, const Frame &frame)
+{
+    fprintf(out, "P6\n%d %d\n255\n", frame.width, frame.height);
+    return fwrite(frame.rgb.data(), 1, frame.rgb.size(), out) == frame.rgb.size();
+}
+
+//true when the pattern holds exactly one integer conversion (flags and width
+//allowed) and otherwise only %% escapes, so it is safe to hand to snprintf
+static bool frame_pattern(const string &pattern)
+{
+    int conversions = 0;
+    for (size_t i=0; i<pattern.size(); i++){
+        if (pattern[i] != '%'){
+            continue;
+        }
+        i += 1;
+        if (i < pattern.size() && pattern[i] == '%'){
+            continue;
+        }
+        while (i < pattern.size() && strchr("0-+ ", pattern[i])){
+            i += 1;
+        }
+        while (i < pattern.size() && isdigit((unsigned char)pattern[i])){
+            i += 1;
+        }
+        if (i >= pattern.size() || (pattern[i] != 'd' && pattern[i] != 'i')){
+            return false;
+        }
+        conversions += 1;
+    }
+    return conversions == 1;
+}
+
+FrameWriter::FrameWriter(const string &target)
+{
+    FrameWriter::target = target;
+    frames = 0;
+    out = NULL;
+    piped = false;
+    if (!target.empty() && target[0] == '|'){
+        format = FRAME_PPM_STREAM;
+        out = popen(target.c_str()+1, "w");
+        piped = true;
+    }
+    else if (target.find('%') != string::npos){
+        format = FRAME_PPM_SEQUENCE;
+        pattern = frame_pattern(target) ? target : "";
+    }
+    else{
+        format = FRAME_RAW;
+        out = target == "-" ? stdout : fopen(target.c_str(), "wb");
+    }
+    if (!IsOpen()){
+        LOG_ERROR("Could not open " << target << " for frames");
+    }
+}
+
+FrameWriter::~FrameWriter()
+{
+    Close();
+}
+
+bool FrameWriter::Write(const Frame &frame)
+{
+    bool ok = false;
+    if (format == FRAME_PPM_SEQUENCE && !pattern.empty()){
+        char name[1024];
+        int length = snprintf(name, sizeof(name), pattern.c_str(), (int)frames);
+        FILE* file = length > 0 && length < (int)sizeof(name) ? fopen(name, "wb") : NULL;
+        if (file){
+            ok = write_ppm(file, frame);
+            ok = fclose(file) == 0 && ok;
+        }
+    }
+    else if (out){
+        if (format == FRAME_PPM_STREAM){
+            ok = write_ppm(out, frame);
+        }
+        else{
+            ok = fwrite(frame.rgb.data(), 1, frame.rgb.size(), out) == frame.rgb.size();
+        }
+    }
+    if (!ok){
+        LOG_ERROR("Could not write frame " << frames << " to " << target);
+        return false;
+    }
+    frames += 1;
+    return true;
+}
+
+void FrameWriter::Close()
+{
+    if (out == NULL){
+        return;
+    }
+    if (piped){
+        pclose(out);
+    }
+    else if (out == stdout){
+        fflush(out);
+    }
+    else{
+        fclose(out);
+    }
+    out = NULL;
+}
@@ -0,0 +1,167 @@
+//
+//  GalleryRenderer.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/20/21.
+//
+
+#include <stdio.h>
+#include <math.h>
+#include <map>
+#include <algorithm>
+#include "GalleryRenderer.h"
+#include "Profile.h"
+#include "RobotMesh.h"
+using namespace std;
+
+//mass count followed by every spring's ends; robots with equal keys can share one spring buffer
+static vector<int> morphology_key(const Robot &robot)
+{
+    vector<int> key;
+    key.reserve(1 + 2*robot.springs.size());
+    key.push_back((int)robot.masses.size());
+    for (int i=0; i<robot.springs.size(); i++){
+        key.push_back(robot.springs[i].m0);
+        key.push_back(robot.springs[i].m1);
+    }
+    return key;
+}
+
+static vector<GLint> spring_ends(const Robot &robot)
+{
+    vector<unsigned int> indices = spring_indices(robot);
+    return vector<GLint>(indices.begin(), indices.end());
+}
+
+//blue for the worst robot of the population, through white, to orange for the best
+static void fitness_color(float t, float color[3])
+{
+    static const float worst[3] = {0.20f, 0.35f, 0.85f};
+    static const float middle[3] = {0.90f, 0.90f, 0.90f};
+    static const float best[3] = {0.95f, 0.55f, 0.10f};
+    const float* from = t < 0.5f ? worst : middle;
+    const float* to = t < 0.5f ? middle : best;
+    float s = t < 0.5f ? 2*t : 2*t-1;
+    for (int c=0; c<3; c++){
+        color[c] = from[c] + (to[c]-from[c])*s;
+    }
+}
+
+MorphologyBatch::MorphologyBatch(const Robot &robot, const vector<int> &members) :
+    members(members),
+    massCount((int)robot.masses.size()),
+    springCount((int)robot.springs.size()),
+    instances(members.size()*6*sizeof(GLfloat), GL_DYNAMIC_DRAW),
+    positions(NULL, members.size()*robot.masses.size()*3*sizeof(GLfloat), GL_R32F, GL_DYNAMIC_DRAW),
+    springs(spring_ends(robot).data(), robot.springs.size()*2*sizeof(GLint), GL_RG32I)
+{
+    vao.Bind();
+    vao.LinkAttrib(instances, 2, 3, GL_FLOAT, 6*sizeof(float), (void*)0);
+    vao.LinkAttrib(instances, 3, 3, GL_FLOAT, 6*sizeof(float), (void*)(3*sizeof(float)));
+    glVertexAttribDivisor(2, 1);
+    glVertexAttribDivisor(3, 1);
+    vao.Unbind();
+    instances.Unbind();
+}
+
+GalleryRenderer::GalleryRenderer(const vector<Robot> &population, float spacing)
+{
+    //group the population by morphology, in order of first appearance
+    map<vector<int>, int> batchOf;
+    vector<vector<int> > groups;
+    for (int r=0; r<population.size(); r++){
+        vector<int> key = morphology_key(population[r]);
+        map<vector<int>, int>::iterator it = batchOf.find(key);
+        if (it == batchOf.end()){
+            it = batchOf.insert(make_pair(key, (int)groups.size())).first;
+            groups.push_back(vector<int>());
+        }
+        groups[it->second].push_back(r);
+    }
+    for (int b=0; b<groups.size(); b++){
+        batches.push_back(MorphologyBatch(population[groups[b][0]], groups[b]));
+    }
+
+    //row by row from the origin, each robot's center of mass in the middle of its cell
+    columns = max((int)ceil(sqrt((double)population.size())), 1);
+    offsets.assign(population.size()*3, 0.0f);
+    for (int r=0; r<population.size(); r++){
+        const Robot &robot = population[r];
+        float center[2] = {0, 0};
+        for (int m=0; m<robot.masses.size(); m++){
+            center[0] += robot.masses[m].position[0];
+            center[1] += robot.masses[m].position[1];
+        }
+        center[0] /= max((int)robot.masses.size(), 1);
+        center[1] /= max((int)robot.masses.size(), 1);
+        offsets[3*r+0] = (r%columns + 0.5f)*spacing - center[0];
+        offsets[3*r+1] = (r/columns + 0.5f)*spacing - center[1];
+    }
+}
+
+void GalleryRenderer::SetUniforms(const Shader &shader)
+{
+    shader.setInt("positions", 0);
+    shader.setInt("springs", 1);
+}
+
+void GalleryRenderer::Update(const vector<Robot> &population, const vector<float> &fitness)
+{
+    PROFILE_SCOPE(PHASE_RENDER_UPLOAD);
+    float lowest = 0;
+    float highest = 0;
+    if (!fitness.empty()){
+        lowest = *min_element(fitness.begin(), fitness.end());
+        highest = *max_element(fitness.begin(), fitness.end());
+    }
+    float range = highest > lowest ? highest-lowest : 1.0f;
+
+    for (int b=0; b<batches.size(); b++){
+        MorphologyBatch &batch = batches[b];
+        staging.resize(batch.members.size()*batch.massCount*3);
+        vector<GLfloat> instanceData(batch.members.size()*6);
+        for (int i=0; i<batch.members.size(); i++){
+            int r = batch.members[i];
+            const Robot &robot = population[r];
+            GLfloat* out = &staging[i*batch.massCount*3];
+            for (int m=0; m<batch.massCount; m++){
+                out[3*m+0] = robot.masses[m].position[0];
+                out[3*m+1] = robot.masses[m].position[1];
+                out[3*m+2] = robot.masses[m].position[2];
+            }
+            instanceData[6*i+0] = offsets[3*r+0];
+            instanceData[6*i+1] = offsets[3*r+1];
+            instanceData[6*i+2] = offsets[3*r+2];
+            fitness_color(r < fitness.size() ? (fitness[r]-lowest)/range : 0.5f, &instanceData[6*i+3]);
+        }
+        batch.positions.Update(staging.data(), staging.size()*sizeof(GLfloat));
+        batch.instances.Bind();
+        batch.instances.Orphan();
+        batch.instances.Update(instanceData.data(), instanceData.size()*sizeof(GLfloat));
+        batch.instances.Unbind();
+    }
+}
+
+void GalleryRenderer::Draw(const Shader &shader)
+{
+    for (int b=0; b<batches.size(); b++){
+        MorphologyBatch &batch = batches[b];
+        shader.setInt("massCount", batch.massCount);
+        batch.positions.Bind(0);
+        batch.springs.Bind(1);
+        batch.vao.Bind();
+        glDrawArraysInstanced(GL_LINES, 0, 2*batch.springCount, (GLsizei)batch.members.size());
+    }
+    glBindVertexArray(0);
+}
+
+void GalleryRenderer::Delete()
+{
+    for (int b=0; b<batches.size(); b++){
+        batches[b].vao.Delete();
+        batches[b].instances.Delete();
+        batches[b].positions.Delete();
+        batches[b].springs.Delete();
+    }
+    batches.clear();
+}
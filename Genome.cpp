@@ -0,0 +1,226 @@
+//
+//  Genome.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/3/22.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Genome.h"
+#include "Logger.h"
+using namespace std;
+
+static void write_varint(BinaryWriter &out, uint32_t value){
+    while (value >= 0x80){
+        out.Write((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.Write((uint8_t)value);
+}
+
+static uint32_t read_varint(BinaryReader &in){
+    uint32_t value = 0;
+    for (int shift=0; shift<35; shift+=7){
+        uint8_t byte = 0;
+        in.Read(byte);
+        value |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)){
+            return value;
+        }
+    }
+    in.ok = false;
+    return 0;
+}
+
+void write_genome(BinaryWriter &out, const Genome &genome){
+    const Morphology &morphology = genome.morphology;
+    out.Write((uint8_t)GENOME_VERSION);
+    write_varint(out, (uint32_t)morphology.parents.size());
+    for (int i=0; i<morphology.parents.size(); i++){
+        write_varint(out, (uint32_t)(morphology.parents[i]*6 + morphology.faces[i]));
+    }
+    write_controller(out, genome.control);
+}
+
+bool read_genome(BinaryReader &in, Genome &genome){
+    uint8_t version = 0;
+    in.Read(version);
+    if (in.ok && version != GENOME_VERSION){
+        LOG_ERROR("Genome version " << (int)version << " is not supported");
+        return false;
+    }
+    uint32_t placements = read_varint(in);
+    //every placement takes at least one byte
+    if (!in.ok || placements > in.Remaining()){
+        in.ok = false;
+        return false;
+    }
+    //decoded into a copy so a truncated or corrupt genome leaves the caller's untouched
+    Genome parsed;
+    parsed.morphology.parents.resize(placements);
+    parsed.morphology.faces.resize(placements);
+    for (int i=0; i<placements; i++){
+        uint32_t packed = read_varint(in);
+        parsed.morphology.parents[i] = packed/6;
+        parsed.morphology.faces[i] = packed%6;
+    }
+    read_controller(in, parsed.control);
+    if (!in.ok){
+        return false;
+    }
+    genome = parsed;
+    return true;
+}
+
+static void append_float(string &out, float value){
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), " %.9g", value);
+    out += buffer;
+}
+
+static void append_floats(string &out, const char* name, const vector<float> &values){
+    out += name;
+    out += ' ';
+    out += to_string(values.size());
+    for (int i=0; i<values.size(); i++){
+        append_float(out, values[i]);
+    }
+    out += '\n';
+}
+
+string genome_to_text(const Genome &genome){
+    const Morphology &morphology = genome.morphology;
+    const Controller &control = genome.control;
+    string out = "genome " + to_string(GENOME_VERSION) + "\n";
+    out += "placements " + to_string(morphology.parents.size()) + "\n";
+    for (int i=0; i<morphology.parents.size(); i++){
+        out += to_string(morphology.parents[i]) + " " + to_string(morphology.faces[i]) + "\n";
+    }
+    out += "motor " + to_string(control.motor.size()) + "\n";
+    for (int i=0; i<control.motor.size(); i++){
+        const Equation &eqn = control.motor[i];
+        string line;
+        append_float(line, eqn.k);
+        append_float(line, eqn.a);
+        append_float(line, eqn.w);
+        append_float(line, eqn.c);
+        out += line.substr(1) + "\n";
+    }
+    append_floats(out, "start", control.start);
+    append_floats(out, "end", control.end);
+    out += "fitness";
+    append_float(out, control.fitness);
+    out += '\n';
+    return out;
+}
+
+static bool read_keyword(const char* &p, const char* keyword){
+    while (*p == ' ' || *p == '\n'){
+        p++;
+    }
+    size_t length = strlen(keyword);
+    if (strncmp(p, keyword, length) != 0){
+        LOG_ERROR("Genome text: expected '" << keyword << "'");
+        return false;
+    }
+    p += length;
+    return true;
+}
+
+//reads "<keyword> <count>"
+static bool read_section(const char* &p, const char* keyword, long &count){
+    if (!read_keyword(p, keyword)){
+        return false;
+    }
+    char* end;
+    count = strtol(p, &end, 10);
+    //each entry takes at least one character, which keeps a corrupt count from allocating wildly
+    if (end == p || count < 0 || count > (long)strlen(end)){
+        LOG_ERROR("Genome text: missing count after '" << keyword << "'");
+        return false;
+    }
+    p = end;
+    return true;
+}
+
+static bool read_float(const char* &p, float &value){
+    char* end;
+    value = strtof(p, &end);
+    if (end == p){
+        LOG_ERROR("Genome text: expected a number");
+        return false;
+    }
+    p = end;
+    return true;
+}
+
+static bool read_int(const char* &p, int &value){
+    char* end;
+    value = (int)strtol(p, &end, 10);
+    if (end == p){
+        LOG_ERROR("Genome text: expected an integer");
+        return false;
+    }
+    p = end;
+    return true;
+}
+
+static bool read_floats(const char* &p, const char* keyword, vector<float> &values){
+    long count;
+    if (!read_section(p, keyword, count)){
+        return false;
+    }
+    values.resize(count);
+    for (int i=0; i<count; i++){
+        if (!read_float(p, values[i])){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool genome_from_text(const string &text, Genome &genome){
+    const char* p = text.c_str();
+    long version;
+    long count;
+    if (!read_section(p, "genome", version)){
+        return false;
+    }
+    if (version != GENOME_VERSION){
+        LOG_ERROR("Genome version " << version << " is not supported");
+        return false;
+    }
+
+    Genome parsed;
+    if (!read_section(p, "placements", count)){
+        return false;
+    }
+    parsed.morphology.parents.resize(count);
+    parsed.morphology.faces.resize(count);
+    for (int i=0; i<count; i++){
+        if (!read_int(p, parsed.morphology.parents[i]) || !read_int(p, parsed.morphology.faces[i])){
+            return false;
+        }
+    }
+
+    if (!read_section(p, "motor", count)){
+        return false;
+    }
+    parsed.control.motor.resize(count);
+    for (int i=0; i<count; i++){
+        Equation &eqn = parsed.control.motor[i];
+        if (!read_float(p, eqn.k) || !read_float(p, eqn.a) || !read_float(p, eqn.w) || !read_float(p, eqn.c)){
+            return false;
+        }
+    }
+    if (!read_floats(p, "start", parsed.control.start) || !read_floats(p, "end", parsed.control.end)){
+        return false;
+    }
+    if (!read_keyword(p, "fitness") || !read_float(p, parsed.control.fitness)){
+        return false;
+    }
+    genome = parsed;
+    return true;
+}
@@ -0,0 +1,105 @@
+//
+//  GenomeBench.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/3/22.
+//
+//  Genome serialization throughput: encodes and decodes random genomes of increasing size in the
+//  packed binary and the text format, reports genomes/s, MB/s and bytes/genome next to the full
+//  Robot encoding, and checks that both formats round-trip and rebuild the identical robot.
+//  Usage: GenomeBench [genomes per row]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Robot.h"
+#include "Genome.h"
+#include "Serialization.h"
+using namespace std;
+
+static double seconds_since(chrono::steady_clock::time_point start){
+    return chrono::duration<double>(chrono::steady_clock::now()-start).count();
+}
+
+static bool same_genome(const Genome &a, const Genome &b){
+    BinaryWriter x;
+    BinaryWriter y;
+    write_genome(x, a);
+    write_genome(y, b);
+    return x.bytes == y.bytes;
+}
+
+int main(int argc, const char * argv[]) {
+    int genomes_per_row = max(argc > 1 ? atoi(argv[1]) : 2000, 1);
+    const int cube_counts[] = {10, 50, 100, 500, 1000};
+
+    printf("%8s %10s %10s %10s %12s %12s %12s %12s %10s %8s\n", "cubes", "bin B", "text B", "robot B", "bin enc/s", "bin dec/s", "text enc/s", "text dec/s", "dec MB/s", "check");
+    for (int c=0; c<sizeof(cube_counts)/sizeof(int); c++){
+        int num_cubes = cube_counts[c];
+        //a few distinct genomes, cycled, so the row measures encoding and not robot generation
+        int distinct = 16;
+        vector<Genome> genomes(distinct);
+        Robot robot;
+        Rng rng(4321 + num_cubes);
+        vector<vector<char>> robots(distinct);
+        size_t robot_bytes = 0;
+        for (int g=0; g<distinct; g++){
+            initialize_robot(robot, num_cubes, rng, &genomes[g].morphology);
+            randomize_controller(genomes[g].control, num_cubes, rng);
+            genomes[g].control.fitness = rng.Uniform();
+            BinaryWriter full;
+            write_robot(full, robot);
+            robots[g] = full.bytes;
+            robot_bytes += full.bytes.size();
+        }
+
+        BinaryWriter out;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int g=0; g<genomes_per_row; g++){
+            write_genome(out, genomes[g % distinct]);
+        }
+        double binary_encode = genomes_per_row/seconds_since(start);
+
+        BinaryReader in(out.bytes.data(), out.bytes.size());
+        Genome decoded;
+        bool ok = true;
+        start = chrono::steady_clock::now();
+        for (int g=0; g<genomes_per_row; g++){
+            ok = read_genome(in, decoded) && ok;
+        }
+        double binary_decode = genomes_per_row/seconds_since(start);
+        ok = ok && in.Remaining() == 0 && same_genome(decoded, genomes[(genomes_per_row-1) % distinct]);
+
+        vector<string> texts(genomes_per_row);
+        size_t text_bytes = 0;
+        start = chrono::steady_clock::now();
+        for (int g=0; g<genomes_per_row; g++){
+            texts[g] = genome_to_text(genomes[g % distinct]);
+        }
+        double text_encode = genomes_per_row/seconds_since(start);
+        start = chrono::steady_clock::now();
+        for (int g=0; g<genomes_per_row; g++){
+            ok = genome_from_text(texts[g], decoded) && ok;
+            text_bytes += texts[g].size();
+        }
+        double text_decode = genomes_per_row/seconds_since(start);
+
+        //the decoded genomes have to give back exactly the robots they were drawn from
+        for (int g=0; g<min(distinct, genomes_per_row) && ok; g++){
+            Robot rebuilt;
+            BinaryWriter full;
+            ok = genome_from_text(texts[g], decoded) && same_genome(decoded, genomes[g]) && build_robot(rebuilt, decoded.morphology);
+            write_robot(full, rebuilt);
+            ok = ok && full.bytes == robots[g];
+        }
+
+        double mb = out.bytes.size()/1e6;
+        printf("%8d %10zu %10zu %10zu %12.0f %12.0f %12.0f %12.0f %10.1f %8s\n", num_cubes, out.bytes.size()/genomes_per_row, text_bytes/genomes_per_row, robot_bytes/distinct, binary_encode, binary_decode, text_encode, text_decode, mb*binary_decode/genomes_per_row, ok ? "ok" : "FAILED");
+    }
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+//
+//  GridRenderer.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/5/21.
+//
+
+#include <stdio.h>
+#include "GridRenderer.h"
+
+//every cell edge lies on one of slices+1 lines per axis, so the grid only needs 2*(slices+1) lines
+static std::vector<GLfloat> grid_lines(int slices, float spacing)
+{
+    std::vector<GLfloat> vertices;
+    float extent = slices*spacing;
+    for (int i=0; i<=slices; i++){
+        float offset = i*spacing;
+        GLfloat line[] = {
+            offset, 0.0f, 0.0f,    offset, extent, 0.0f, // parallel to y
+            0.0f, offset, 0.0f,    extent, offset, 0.0f, // parallel to x
+        };
+        vertices.insert(vertices.end(), line, line + sizeof(line)/sizeof(GLfloat));
+    }
+    return vertices;
+}
+
+GridRenderer::GridRenderer(int slices, float spacing) :
+    vertices(grid_lines(slices, spacing)),
+    vbo(vertices.data(), vertices.size()*sizeof(GLfloat))
+{
+    vao.Bind();
+    vao.LinkAttrib(vbo, 0, 3, GL_FLOAT, 3*sizeof(float), (void*)0);
+    vao.Unbind();
+    vbo.Unbind();
+}
+
+void GridRenderer::Draw()
+{
+    vao.Bind();
+    glDrawArrays(GL_LINES, 0, (GLsizei)(vertices.size()/3));
+    vao.Unbind();
+}
+
+void GridRenderer::Delete()
+{
+    vao.Delete();
+    vbo.Delete();
+}
@@ -0,0 +1,43 @@
+//
+//  Checkpoint.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/2/22.
+//
+
+#ifndef CHECKPOINT_CLASS_h
+#define CHECKPOINT_CLASS_h
+
+#include <stdint.h>
+#include <vector>
+
+#include "Robot.h"
+#include "Random.h"
+
+#define CHECKPOINT_VERSION 1
+
+// everything a run needs to carry on exactly where it stopped: the simulated robot with its
+// controller, the physics globals, the random generator and the evolution population. Restoring
+// a checkpoint and stepping on gives the same floats, bit for bit, as never having stopped.
+struct Checkpoint{
+    float T;
+    float dt;
+    bool breathing;
+    Rng rng;
+    Robot robot;
+    Controller control;
+    long generation;
+    std::vector<Robot> population;
+    std::vector<Controller> controllers; // one per population member, or empty
+};
+
+// fills T, dt and breathing from the globals / puts them back
+void capture_globals(Checkpoint &checkpoint);
+void restore_globals(const Checkpoint &checkpoint);
+
+// the file is a fixed header (magic, version, payload size, checksum) followed by the payload;
+// saving replaces the old file atomically, loading rejects truncated, corrupt or newer files
+bool save_checkpoint(const char* filename, const Checkpoint &checkpoint);
+bool load_checkpoint(const char* filename, Checkpoint &checkpoint);
+
+#endif /* Checkpoint_h */
@@ -0,0 +1,44 @@
+//
+//  Energy.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/5/22.
+//
+
+#ifndef ENERGY_CLASS_h
+#define ENERGY_CLASS_h
+
+#include <vector>
+#include "Robot.h"
+
+// the last capacity EnergySamples, one every interval substeps. The stepping loop asks Sample(step)
+// for a slot and passes it to update_forces, which fills it while computing the forces anyway:
+//
+//     update_forces(robot, energy.Sample(step));
+//
+// Not thread-safe; it belongs to whichever thread steps the robot.
+class EnergyLog
+{
+public:
+    int interval;
+
+    EnergyLog(int capacity = 4096, int interval = 100);
+
+    // the slot for this step's sample, or NULL when the step is not on the interval
+    EnergySample* Sample(long step);
+
+    int Size() const { return (int)count; }
+    // i = 0 is the oldest sample still kept
+    const EnergySample& operator[](int i) const { return samples[(next + samples.size() - count + i) % samples.size()]; }
+    const EnergySample& Newest() const { return (*this)[(int)count-1]; }
+    // relative change of the total between the oldest and newest kept sample
+    float Drift() const;
+    void Clear() { next = 0; count = 0; }
+
+private:
+    std::vector<EnergySample> samples;
+    size_t next;
+    size_t count;
+};
+
+#endif /* Energy_h */
@@ -0,0 +1,49 @@
+//
+//  FrameWriter.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/18/21.
+//
+
+#ifndef FRAMEWRITER_CLASS_h
+#define FRAMEWRITER_CLASS_h
+
+#include <stdio.h>
+#include <string>
+
+#include "SoftwareRenderer.h"
+
+enum FrameFormat
+{
+    FRAME_PPM_SEQUENCE, // one binary PPM file per frame
+    FRAME_PPM_STREAM, // PPM frames back to back into a command (ffmpeg -f image2pipe -i -)
+    FRAME_RAW // bare RGB24, top row first (ffmpeg -f rawvideo -pix_fmt rgb24 -s WxH -i -)
+};
+
+// sends rendered frames somewhere, in order. The target picks the format:
+//   "frames/%05d.ppm"  a printf pattern with one integer conversion: one PPM per frame
+//   "|command"         PPM stream into the command's standard input
+//   "-"                raw RGB on standard output
+//   anything else      raw RGB into that file
+class FrameWriter
+{
+public:
+    FrameFormat format;
+    long frames; // frames written so far
+
+    FrameWriter(const std::string &target);
+    ~FrameWriter();
+
+    bool IsOpen() const { return (format == FRAME_PPM_SEQUENCE && !pattern.empty()) || out != NULL; }
+    // false (and logs) when the frame could not be written
+    bool Write(const Frame &frame);
+    void Close();
+
+private:
+    std::string target;
+    std::string pattern; // validated printf pattern, empty when rejected
+    FILE* out;
+    bool piped;
+};
+
+#endif /* FrameWriter_h */
@@ -0,0 +1,59 @@
+//
+//  GalleryRenderer.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/20/21.
+//
+
+#ifndef GALLERYRENDERER_CLASS_h
+#define GALLERYRENDERER_CLASS_h
+
+#include <vector>
+#include <glad/glad.h>
+
+#include "VAO.h"
+#include "VBO.h"
+#include "TBO.h"
+#include "Robot.h"
+#include "shaderClass.h"
+
+// every robot of one morphology (same masses and springs) is an instance of one draw
+struct MorphologyBatch{
+    std::vector<int> members; // indices into the population
+    int massCount;
+    int springCount;
+    VAO vao; // per instance offset (location 2) and color (location 3)
+    VBO instances; // 6 floats per member: offset, color
+    TBO positions; // GL_R32F, x, y, z of every mass of every member, member after member
+    TBO springs; // GL_RG32I, m0, m1 per spring, shared by all members
+
+    MorphologyBatch(const Robot &robot, const std::vector<int> &members);
+};
+
+// draws a whole population side by side on the grid with one glDrawArraysInstanced per
+// morphology (gallery.vert); each robot gets its own cell and is colored by its fitness
+// relative to the rest of the population. Draw binds positions and springs to texture units 0 and 1.
+class GalleryRenderer
+{
+public:
+    std::vector<MorphologyBatch> batches;
+    std::vector<float> offsets; // {x, y, z} per robot, moves the robot into its cell
+    int columns;
+
+    // spacing is the cell size; robots are centered in their cell from their current positions
+    GalleryRenderer(const std::vector<Robot> &population, float spacing);
+
+    // points the program's samplers at the units Draw uses; the program has to be active
+    static void SetUniforms(const Shader &shader);
+
+    // uploads every robot's masses and recolors the instances by fitness
+    void Update(const std::vector<Robot> &population, const std::vector<float> &fitness);
+    // the program has to be active (massCount is set per batch)
+    void Draw(const Shader &shader);
+    void Delete();
+
+private:
+    std::vector<GLfloat> staging;
+};
+
+#endif /* GalleryRenderer_h */
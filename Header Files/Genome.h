@@ -0,0 +1,36 @@
+//
+//  Genome.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/3/22.
+//
+
+#ifndef GENOME_CLASS_h
+#define GENOME_CLASS_h
+
+#include <string>
+
+#include "Robot.h"
+#include "Serialization.h"
+
+#define GENOME_VERSION 1
+
+// what evolution actually varies: the placements that build the body and the controller that
+// drives it. A few bytes per cube instead of the ~2.5 KB per cube of the built Robot.
+struct Genome{
+    Morphology morphology;
+    Controller control;
+};
+
+// packed binary encoding for shipping genomes between processes: a version byte, each placement
+// as one varint (parent*6 + face), then the controller with its floats stored bit for bit.
+// Genomes can be appended back to back into one writer and read back one at a time.
+void write_genome(BinaryWriter &out, const Genome &genome);
+bool read_genome(BinaryReader &in, Genome &genome);
+
+// line oriented text encoding for inspection and diffs; floats are printed with 9 significant
+// digits so reading the text back gives the identical genome
+std::string genome_to_text(const Genome &genome);
+bool genome_from_text(const std::string &text, Genome &genome);
+
+#endif /* Genome_h */
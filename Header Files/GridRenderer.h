@@ -0,0 +1,31 @@
+//
+//  GridRenderer.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/5/21.
+//
+
+#ifndef GRIDRENDERER_CLASS_h
+#define GRIDRENDERER_CLASS_h
+
+#include <vector>
+#include <glad/glad.h>
+
+#include "VAO.h"
+#include "VBO.h"
+
+// the ground grid as one static GL_LINES mesh: slices x slices cells of size spacing, starting at the origin
+class GridRenderer
+{
+public:
+    std::vector<GLfloat> vertices; // declared before vbo, which is built from it
+    VAO vao;
+    VBO vbo;
+
+    GridRenderer(int slices, float spacing);
+
+    void Draw();
+    void Delete();
+};
+
+#endif /* GridRenderer_h */
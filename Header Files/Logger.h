@@ -0,0 +1,103 @@
+//
+//  Logger.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 11/14/21.
+//
+
+#ifndef LOGGER_CLASS_h
+#define LOGGER_CLASS_h
+
+#include <string>
+#include <sstream>
+#include <utility>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+// numeric levels so they can be compared by the preprocessor
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_WARN  3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_OFF   5
+
+// statements below this level are removed at compile time (pass -DLOG_COMPILE_LEVEL=0 to get everything back)
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_INFO
+#endif
+
+class Logger
+{
+public:
+    static Logger& Get();
+
+    // statements below this level are dropped at runtime (default is info)
+    void SetLevel(int level);
+    bool Enabled(int level) const { return level >= minLevel; }
+
+    // queues the message for the background writer; errors are flushed right away
+    void Write(int level, const std::string &message);
+    void Flush();
+
+    ~Logger();
+
+private:
+    Logger();
+    void Run();
+
+    int minLevel;
+    bool stopping;
+    bool writing;
+    std::deque<std::string> queue;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable drained;
+    std::thread writer;
+};
+
+#define LOG_AT(level, msg) \
+    do { \
+        if (Logger::Get().Enabled(level)) { \
+            std::ostringstream log_stream_; \
+            log_stream_ << msg; \
+            Logger::Get().Write(level, log_stream_.str()); \
+        } \
+    } while (0)
+
+// sizeof keeps the message type-checked (and its variables "used") without generating any code
+#define LOG_ELIDED(msg) do { (void)sizeof(std::declval<std::ostream&>() << msg); } while (0)
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE(msg) LOG_AT(LOG_LEVEL_TRACE, msg)
+#else
+#define LOG_TRACE(msg) LOG_ELIDED(msg)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(msg) LOG_AT(LOG_LEVEL_DEBUG, msg)
+#else
+#define LOG_DEBUG(msg) LOG_ELIDED(msg)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(msg) LOG_AT(LOG_LEVEL_INFO, msg)
+#else
+#define LOG_INFO(msg) LOG_ELIDED(msg)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(msg) LOG_AT(LOG_LEVEL_WARN, msg)
+#else
+#define LOG_WARN(msg) LOG_ELIDED(msg)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(msg) LOG_AT(LOG_LEVEL_ERROR, msg)
+#else
+#define LOG_ERROR(msg) LOG_ELIDED(msg)
+#endif
+
+#endif /* Logger_h */
@@ -0,0 +1,57 @@
+//
+//  ParallelPhysics.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 11/27/21.
+//
+
+#ifndef PARALLELPHYSICS_CLASS_h
+#define PARALLELPHYSICS_CLASS_h
+
+#include <vector>
+#include "Robot.h"
+#include "ThreadPool.h"
+
+enum ReductionMode
+{
+    // every worker sums its springs into a private force buffer and the buffers are added up
+    // afterwards; fastest, but the summation order (and so the last bits) changes with the thread count
+    REDUCTION_FAST,
+    // spring forces are stored per spring and every mass adds its springs in ascending spring order;
+    // trajectories are bit-identical to the serial update_forces for any thread count
+    // (as long as it is not built with -ffast-math or FMA contraction)
+    REDUCTION_DETERMINISTIC
+};
+
+// threaded version of update_forces / update_pos_vel_acc / reset_forces
+class ParallelPhysics
+{
+public:
+    ReductionMode mode;
+
+    ParallelPhysics(int num_threads, ReductionMode mode);
+
+    // rebuilds the mass -> spring table and the scratch buffers; call again whenever the topology changes
+    void Prepare(const Robot &robot);
+
+    void UpdateForces(Robot &robot);
+    void UpdatePosVelAcc(Robot &robot);
+    void ResetForces(Robot &robot);
+
+    // one substep: time, breathing, forces, integration, reset (same order as the render loop in main)
+    void Step(Robot &robot, Controller &control);
+
+    int Threads() const { return pool.Size(); }
+
+private:
+    void SpringForces(Robot &robot, int begin, int end, int worker);
+    void ExternalForces(Robot &robot, int begin, int end);
+
+    ThreadPool pool;
+    std::vector<int> springStart; // CSR offsets into springList, one entry per mass plus one
+    std::vector<int> springList; // incident springs of every mass, ascending, negative (-id-1) when the mass is m1
+    std::vector<float> springForce; // force on m0 of every spring, 3 floats per spring
+    std::vector<std::vector<float> > partial; // per worker force buffers for REDUCTION_FAST
+};
+
+#endif /* ParallelPhysics_h */
@@ -0,0 +1,18 @@
+//
+//  Population.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 11/20/21.
+//
+
+#ifndef POPULATION_CLASS_h
+#define POPULATION_CLASS_h
+
+#include <vector>
+#include "Robot.h"
+
+// builds population_size random robots of num_cubes cubes each, spread over num_threads threads
+// (0 = one per core); robot i always comes from Rng::Stream(seed, i), whatever the thread count
+void build_population(std::vector<Robot> &population, int population_size, int num_cubes, uint64_t seed, int num_threads);
+
+#endif /* Population_h */
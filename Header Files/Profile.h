@@ -0,0 +1,131 @@
+//
+//  Profile.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/8/22.
+//
+
+#ifndef PROFILE_CLASS_h
+#define PROFILE_CLASS_h
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <chrono>
+
+// off by default: every PROFILE_ macro expands to nothing. Build with -DPROFILE_ENABLED=1 to get
+// the per-phase timers and event counters in the step loop.
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED 0
+#endif
+
+enum ProfilePhase{
+    PHASE_ACTUATION, // update_breathing
+    PHASE_SPRINGS, // spring forces
+    PHASE_EXTERNAL, // gravity, ground and friction (and the force reduction in ParallelPhysics)
+    PHASE_INTEGRATION, // integrate_mass over all masses
+    PHASE_CUBE_SYNC, // sync_cube over all cubes
+    PHASE_RENDER_UPLOAD, // positions to the GPU
+    PHASE_COUNT
+};
+
+enum ProfileEvent{
+    EVENT_CONTACTS, // a mass below the ground, pushed back up
+    EVENT_STATIC_FRICTION, // a mass held in place by static friction
+    EVENT_KINETIC_FRICTION, // a mass sliding against kinetic friction
+    EVENT_COUNT
+};
+
+struct ProfileTotals{
+    uint64_t ticks[PHASE_COUNT];
+    uint64_t calls[PHASE_COUNT];
+    uint64_t events[EVENT_COUNT];
+};
+
+// one block of counters per thread, so the hot path never shares a cache line or takes a lock;
+// only the owning thread writes its block, Totals() reads them all with relaxed loads.
+// The alignment also pads the size, and C++17 new honours it for the heap allocated blocks
+struct alignas(64) ProfileCounters{
+    std::atomic<uint64_t> ticks[PHASE_COUNT];
+    std::atomic<uint64_t> calls[PHASE_COUNT];
+    std::atomic<uint64_t> events[EVENT_COUNT];
+};
+
+class Profiler
+{
+public:
+    static Profiler& Get();
+
+    // the calling thread's counters
+    static ProfileCounters& Local()
+    {
+        thread_local ProfileCounters* counters = Get().Register();
+        return *counters;
+    }
+
+    // timestamp counter on x86, steady_clock nanoseconds elsewhere
+    static uint64_t Ticks();
+
+    static void Add(std::atomic<uint64_t> &counter, uint64_t amount)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static void Count(ProfileEvent event, uint64_t amount = 1) { Add(Local().events[event], amount); }
+
+    // sums of all threads, including threads that have finished
+    ProfileTotals Totals();
+    double TicksPerSecond();
+    // phase times, calls and events since the last Summary (or since the start); call from one thread
+    std::string Summary();
+    // logs Summary() if at least seconds passed since the last dump; for the render loop
+    void DumpEvery(double seconds);
+
+private:
+    Profiler();
+    ProfileCounters* Register();
+
+    std::mutex lock;
+    std::vector<std::unique_ptr<ProfileCounters> > threads;
+    ProfileTotals last;
+    uint64_t startTicks;
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point lastDump;
+};
+
+// adds the time until the end of the enclosing scope to a phase
+class ProfileScope
+{
+public:
+    ProfileScope(ProfilePhase phase) : phase(phase), start(Profiler::Ticks()) {}
+    ~ProfileScope()
+    {
+        ProfileCounters &counters = Profiler::Local();
+        Profiler::Add(counters.ticks[phase], Profiler::Ticks() - start);
+        Profiler::Add(counters.calls[phase], 1);
+    }
+
+private:
+    ProfilePhase phase;
+    uint64_t start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#if PROFILE_ENABLED
+#define PROFILE_SCOPE(phase) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(phase)
+#define PROFILE_COUNT(event) Profiler::Count(event)
+#define PROFILE_COUNT_N(event, n) Profiler::Count(event, n)
+#define PROFILE_DUMP(seconds) Profiler::Get().DumpEvery(seconds)
+#else
+#define PROFILE_SCOPE(phase) do {} while (0)
+#define PROFILE_COUNT(event) do {} while (0)
+#define PROFILE_COUNT_N(event, n) do {} while (0)
+#define PROFILE_DUMP(seconds) do {} while (0)
+#endif
+
+#endif /* Profile_h */
@@ -0,0 +1,91 @@
+//
+//  Random.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 11/21/21.
+//
+
+#ifndef RANDOM_CLASS_h
+#define RANDOM_CLASS_h
+
+#include <stdint.h>
+
+// xoshiro256** seeded through splitmix64. Every run is fully determined by its master seed:
+// each robot, thread or worker gets its own stream with Rng::Stream(seed, index), and the
+// streams are independent of how the work is scheduled.
+class Rng
+{
+public:
+    typedef uint32_t result_type;
+
+    uint64_t s[4];
+
+    Rng(uint64_t seed = 0) { Seed(seed); }
+
+    static Rng Stream(uint64_t seed, uint64_t index)
+    {
+        //mix the index in before seeding so neighbouring streams share no state
+        uint64_t mixed = seed;
+        SplitMix(mixed);
+        mixed ^= index * 0xd1342543de82ef95ULL;
+        return Rng(SplitMix(mixed));
+    }
+
+    void Seed(uint64_t seed)
+    {
+        uint64_t x = seed;
+        for (int i=0; i<4; i++){
+            s[i] = SplitMix(x);
+        }
+    }
+
+    uint64_t Next()
+    {
+        uint64_t result = Rotl(s[1]*5, 7)*9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = Rotl(s[3], 45);
+        return result;
+    }
+
+    // so rng() % n and <random> distributions keep working
+    result_type operator()() { return (result_type)(Next() >> 32); }
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xffffffffu; }
+
+    // unbiased integer in [0, n)
+    uint32_t Below(uint32_t n)
+    {
+        uint64_t m = (uint64_t)(*this)() * n;
+        uint32_t low = (uint32_t)m;
+        if (low < n){
+            uint32_t threshold = (0u - n) % n;
+            while (low < threshold){
+                m = (uint64_t)(*this)() * n;
+                low = (uint32_t)m;
+            }
+        }
+        return (uint32_t)(m >> 32);
+    }
+
+    // float in [0, 1)
+    float Uniform() { return (Next() >> 40) * (1.0f/16777216.0f); }
+    float Uniform(float lo, float hi) { return lo + (hi-lo)*Uniform(); }
+
+private:
+    static uint64_t Rotl(uint64_t x, int k) { return (x << k) | (x >> (64-k)); }
+
+    static uint64_t SplitMix(uint64_t &x)
+    {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+};
+
+#endif /* Random_h */
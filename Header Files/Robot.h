@@ -0,0 +1,128 @@
+//
+//  Robot.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 11/20/21.
+//
+
+#ifndef ROBOT_CLASS_h
+#define ROBOT_CLASS_h
+
+#include <vector>
+#include <stddef.h>
+#include "Random.h"
+
+struct PointMass{
+    double mass;
+    std::vector<float> position; // {x, y, z}
+    std::vector<float> velocity; // {v_x, v_y, v_z}
+    std::vector<float> acceleration; // {a_x, a_y, a_z}
+    std::vector<float> forces; // {f_x, f_y, f_z}
+    int ID; //index of where a particular mass lies in the robot.masses vector https://forms.gle/bKtGGQKmbtsS6kSV7
+    
+};
+
+struct Spring{
+    float L0; // resting length
+    float L; // current length
+    float k; // spring constant
+    int m0; // connected to which PointMass
+    int m1; // connected to which PointMass
+    float original_L0;
+    int ID; //the index of where a particular string lies in the robot.springs vector
+};
+
+struct Cube{
+    std::vector<PointMass> masses;
+    std::vector<Spring> springs;
+    std::vector<int> joinedCubes;
+    std::vector<int> otherFaces; //faces of other cubes that are joined to it
+    std::vector<int> joinedFaces; //faces of the cube that are joined to other cubes
+    std::vector<int> massIDs; //where the verteces of the cube correspond to the Robot.masses vector
+    std::vector<int> springIDs; //where the springs of the cube correspond to the Robot.springs vector
+    std::vector<int> free_faces;
+    std::vector<float> center;
+};
+
+struct Robot{
+    std::vector<PointMass> masses; //vector of masses that make up the robot
+    std::vector<Spring> springs; //vector of springs that make up the robot
+    std::vector<int> cubes;
+    std::vector<Cube> all_cubes;
+    std::vector<int> available_cubes;
+};
+
+struct Equation{
+    float k;
+    float a;
+    float w;
+    float c;
+};
+
+struct Controller{
+    std::vector<Equation> motor;
+    std::vector<float> start;
+    std::vector<float> end;
+    float fitness;
+};
+
+// how initialize_robot put a robot together: cube i+1 was fused onto face faces[i] of cube parents[i].
+// Together with a Controller this is the whole genome; build_robot turns it back into the same robot.
+struct Morphology{
+    std::vector<int> parents;
+    std::vector<int> faces;
+};
+
+// energy of the robot at one instant, in joules; gravity is measured from z = 0 and contact is the
+// ground penalty spring. Friction and breathing (which moves the rest lengths) change the total on
+// purpose, so drift is only a sanity check with breathing off.
+struct EnergySample{
+    long step;
+    float time;
+    float kinetic;
+    float elastic;
+    float gravity;
+    float contact;
+    float Total() const { return kinetic + elastic + gravity + contact; }
+};
+
+struct LocalityStats{
+    long misses_before; // simulated cache misses of one update_forces sweep before reordering
+    long misses_after; // same sweep after reordering
+    double span_before; // mean |m0-m1| over all springs before reordering
+    double span_after; // mean |m0-m1| over all springs after reordering
+};
+
+const double g = -9.81; //acceleration due to gravity
+const double b = 1; //damping (optional) Note: no damping means your cube will bounce forever
+const float spring_constant = 5000.0f; //this worked best for me given my dt and mass of each PointMass
+const float mu_s = 0.74; //coefficient of static friction
+const float mu_k = 0.57; //coefficient of kinetic friction
+extern float T;
+extern float dt;
+extern bool breathing;
+
+void initialize_masses(std::vector<PointMass> &masses);
+void initialize_springs(std::vector<Spring> &springs);
+void integrate_mass(PointMass &mass);
+void sync_cube(Robot &robot, int j);
+float spring_force(Robot &robot, int i, float direction[3]);
+void apply_external_forces(PointMass &mass);
+void update_pos_vel_acc(Robot &robot);
+// with energy set, also sums the energy of the state the forces are computed from, in the same sweeps
+void update_forces(Robot &robot, EnergySample *energy = NULL);
+void measure_energy(const Robot &robot, EnergySample &energy);
+void reset_forces(Robot &robot);
+void update_breathing(Robot &robot, Controller &control);
+void initialize_robot(Robot &robot, int num_cubes, Rng &rng, Morphology *morphology = NULL);
+bool build_robot(Robot &robot, const Morphology &morphology);
+void initialize_cube(Cube &cube);
+void initialize_controller(Controller &control);
+void randomize_controller(Controller &control, int num_cubes, Rng &rng);
+void mutate_controller(Controller &control, float rate, Rng &rng);
+void fuse_faces(Cube &cube1, Cube &cube2, int cube1_index, int cube2_index, std::vector<PointMass> &masses, std::vector<Spring> &springs, int combine1, int combine2, std::vector<int> &masses_left, std::vector<int> &springs_left);
+LocalityStats reorder_robot(Robot &robot, bool measure = true);
+long count_cache_misses(const Robot &robot);
+size_t robot_memory_bytes(const Robot &robot);
+
+#endif /* Robot_h */
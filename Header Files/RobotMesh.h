@@ -0,0 +1,25 @@
+//
+//  RobotMesh.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/18/21.
+//
+
+#ifndef ROBOTMESH_CLASS_h
+#define ROBOTMESH_CLASS_h
+
+#include <vector>
+#include "Robot.h"
+
+// what the robot looks like, without any GL: shared by RobotRenderer and SoftwareRenderer
+// so the window and the exported frames draw exactly the same lines in the same colors
+
+// one line per spring, straight from the robot's spring list
+std::vector<unsigned int> spring_indices(const Robot &robot);
+// unactuated rest length (original_L0) of every spring, the reference for strain
+std::vector<float> rest_lengths(const Robot &robot);
+// tan at rest, fading to red when stretched and to blue when compressed; |strain| >= scale is fully saturated
+// (robot.vert does the same on the GPU)
+void strain_color(float strain, float scale, float color[3]);
+
+#endif /* RobotMesh_h */
@@ -0,0 +1,52 @@
+//
+//  RobotRenderer.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/4/21.
+//
+
+#ifndef ROBOTRENDERER_CLASS_h
+#define ROBOTRENDERER_CLASS_h
+
+#include <vector>
+#include <glad/glad.h>
+
+#include "VAO.h"
+#include "TBO.h"
+#include "Robot.h"
+#include "RobotMesh.h"
+#include "shaderClass.h"
+
+// draws the whole robot as one glDrawArrays(GL_LINES) with no vertex attributes: robot.vert
+// fetches both ends of every spring from buffer textures and colors the line by its strain.
+// Only the mass positions (3 floats per mass) are uploaded each frame; the spring ends and
+// rest lengths are static. Draw binds the buffers to texture units 0-2, which is where the
+// program's positions, springs and restLengths samplers have to point (see SetUniforms).
+class RobotRenderer
+{
+public:
+    int springCount;
+    VAO vao; // empty, core profile needs one bound to draw
+    TBO positions; // GL_R32F, x, y, z per mass, rewritten every frame
+    TBO springs; // GL_RG32I, m0, m1 per spring
+    TBO restLengths; // GL_R32F, original_L0 per spring
+
+    RobotRenderer(const Robot &robot);
+
+    // points the program's samplers at the units Draw uses; the program has to be active
+    static void SetUniforms(const Shader &shader, float strainScale);
+
+    // copies the current mass positions into the position buffer
+    void Update(const Robot &robot);
+    // same from a flat {x, y, z} array, e.g. a RobotSnapshot
+    void Update(const std::vector<float> &positions);
+    // same from a pointer to 3 floats per mass, e.g. a frame of a memory-mapped trajectory
+    void Update(const float* positions);
+    void Draw();
+    void Delete();
+
+private:
+    std::vector<GLfloat> staging;
+};
+
+#endif /* RobotRenderer_h */
@@ -0,0 +1,46 @@
+//
+//  Scheduler.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/12/21.
+//
+
+#ifndef SCHEDULER_CLASS_h
+#define SCHEDULER_CLASS_h
+
+// decides how many substeps of length step to run so that simulated time advances at factor x
+// wall time (0 = as fast as possible). Batches are sized from the measured cost of a substep so
+// one batch never takes much longer than budget seconds; when the machine cannot keep up the
+// debt is dropped instead of piling up, and achieved shows the rate that was really reached.
+// All times are wall-clock seconds from the caller's clock.
+class Scheduler
+{
+public:
+    double step; // simulated seconds per substep
+    double budget; // longest a batch should take, in wall seconds
+    double factor; // target simulated seconds per wall second, 0 for no limit
+    double cost; // smoothed wall seconds per substep
+    double achieved; // simulated seconds per wall second over the last window
+
+    Scheduler(double step, double budget, double factor);
+
+    // restarts the schedule from (now, steps) so a new factor does not inherit the old debt
+    void SetFactor(double factor, double now, long steps);
+
+    // substeps to run right now; 0 when the next one is not due yet
+    int Plan(double now, long steps);
+    // wall seconds until the next substep is due (never more than budget)
+    double Idle(double now, long steps) const;
+    // feeds back a batch of substeps that took elapsed seconds and finished at now
+    void Record(int substeps, double elapsed, double now, long steps);
+
+private:
+    int MaxBatch() const;
+
+    double anchorTime;
+    long anchorSteps;
+    double windowTime;
+    long windowSteps;
+};
+
+#endif /* Scheduler_h */
@@ -0,0 +1,94 @@
+//
+//  Serialization.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/2/22.
+//
+
+#ifndef SERIALIZATION_CLASS_h
+#define SERIALIZATION_CLASS_h
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "Robot.h"
+
+// building blocks of the binary files (checkpoints, genomes): values are stored as their native
+// bytes and vectors as a uint32 count followed by the elements, so a float read back is bit for
+// bit the float that was written. Only for trivially copyable types.
+class BinaryWriter
+{
+public:
+    std::vector<char> bytes;
+
+    template <typename T>
+    void Write(const T &value)
+    {
+        const char* p = (const char*)&value;
+        bytes.insert(bytes.end(), p, p + sizeof(T));
+    }
+
+    template <typename T>
+    void WriteVector(const std::vector<T> &values)
+    {
+        Write((uint32_t)values.size());
+        const char* p = (const char*)values.data();
+        bytes.insert(bytes.end(), p, p + values.size()*sizeof(T));
+    }
+};
+
+// reads what BinaryWriter wrote; running past the end clears ok and yields zeros instead of crashing
+class BinaryReader
+{
+public:
+    bool ok;
+
+    BinaryReader(const char* data, size_t size) : ok(true), data(data), size(size), offset(0) {}
+
+    size_t Remaining() const { return size - offset; }
+
+    template <typename T>
+    void Read(T &value)
+    {
+        if (!ok || Remaining() < sizeof(T)){
+            ok = false;
+            memset((void*)&value, 0, sizeof(T));
+            return;
+        }
+        memcpy((void*)&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+    }
+
+    template <typename T>
+    void ReadVector(std::vector<T> &values)
+    {
+        uint32_t count = 0;
+        Read(count);
+        if (!ok || count > Remaining()/sizeof(T)){
+            ok = false;
+            values.clear();
+            return;
+        }
+        values.resize(count);
+        memcpy((void*)values.data(), data + offset, count*sizeof(T));
+        offset += count*sizeof(T);
+    }
+
+private:
+    const char* data;
+    size_t size;
+    size_t offset;
+};
+
+void write_robot(BinaryWriter &out, const Robot &robot);
+void read_robot(BinaryReader &in, Robot &robot);
+void write_controller(BinaryWriter &out, const Controller &control);
+void read_controller(BinaryReader &in, Controller &control);
+
+uint64_t fnv1a(const char* data, size_t size);
+// writes to filename.tmp and renames it over filename, so a crash never leaves half a file behind
+bool write_file_atomically(const char* filename, const std::vector<char> &bytes);
+bool read_file(const char* filename, std::vector<char> &bytes);
+
+#endif /* Serialization_h */
@@ -0,0 +1,71 @@
+//
+//  Simulation.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/11/21.
+//
+
+#ifndef SIMULATION_CLASS_h
+#define SIMULATION_CLASS_h
+
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include "Robot.h"
+#include "TripleBuffer.h"
+#include "Trajectory.h"
+#include "Energy.h"
+
+struct RobotSnapshot{
+    std::vector<float> positions; // {x, y, z} of every mass, in robot.masses order
+    float time; // T when the snapshot was taken
+    long steps; // substeps run so far
+    float target; // real-time factor the scheduler aims for (0 = as fast as possible)
+    float achieved; // real-time factor it actually reached
+    float substep_cost; // measured wall seconds per substep
+    EnergySample energy; // newest energy sample
+};
+
+// runs the substeps on its own thread and publishes the mass positions after every batch,
+// so the render loop only ever reads snapshots and never waits on (or slows down) the physics.
+// A Scheduler paces the batches to the real-time factor and keeps each one within budget seconds.
+// The robot and controller belong to the simulation thread between Start and Stop.
+class Simulation
+{
+public:
+    // energy sampled by the step itself, every 100 substeps by default; read it after Stop
+    EnergyLog energy;
+
+    Simulation(Robot &robot, Controller &control, double factor = 1.0, double budget = 0.004);
+    ~Simulation();
+
+    void Start();
+    void Stop();
+
+    // records the run (from the current state on) while the simulation thread steps; set before Start
+    void Record(TrajectoryRecorder* recorder) { Simulation::recorder = recorder; }
+
+    // simulated seconds per wall second, 0 for as fast as possible; safe to call from any thread
+    void SetRealTimeFactor(double factor) { target = factor; }
+
+    // render side: moves to the newest complete snapshot, false if none arrived since the last call
+    bool Acquire() { return snapshots.Acquire(); }
+    const RobotSnapshot& Latest() const { return snapshots.Front(); }
+
+private:
+    void Run();
+    void Publish(float achieved, float substep_cost);
+
+    Robot &robot;
+    Controller &control;
+    double budget; // longest a batch may take before a snapshot is due, in seconds
+    std::atomic<double> target;
+    long steps;
+    TrajectoryRecorder* recorder;
+    std::atomic<bool> stopping;
+    std::thread worker;
+    TripleBuffer<RobotSnapshot> snapshots;
+};
+
+#endif /* Simulation_h */
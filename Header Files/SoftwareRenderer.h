@@ -0,0 +1,51 @@
+//
+//  SoftwareRenderer.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/18/21.
+//
+
+#ifndef SOFTWARERENDERER_CLASS_h
+#define SOFTWARERENDERER_CLASS_h
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Robot.h"
+
+struct Frame{
+    int width;
+    int height;
+    std::vector<unsigned char> rgb; // 3 bytes per pixel, top row first
+    std::vector<float> depth; // window-space depth per pixel, 1 is the far plane
+};
+
+// draws what the viewer draws (ground grid + strain-colored spring wireframe) into a Frame on the CPU, for
+// machines without a display or GPU. It goes through the same view/proj/model matrices as the
+// shaders, clips against the view volume and depth-tests with GL_LESS, so frames look like
+// the window. Render only reads the renderer, so several threads can render different frames.
+class SoftwareRenderer
+{
+public:
+    int width;
+    int height;
+    glm::mat4 view;
+    glm::mat4 proj;
+    glm::mat4 model; // the robot's model matrix; the grid is drawn untransformed
+    float background[3];
+    float strainScale; // same meaning as in robot.vert
+
+    SoftwareRenderer(const Robot &robot, int width, int height);
+
+    // sizes frame if needed, clears it and draws the grid and the robot at positions ({x, y, z} per mass)
+    void Render(const std::vector<float> &positions, Frame &frame) const;
+
+private:
+    void Line(Frame &frame, glm::vec4 a, glm::vec4 b, const float* colorA, const float* colorB) const;
+
+    std::vector<unsigned int> indices;
+    std::vector<float> restLengths;
+    std::vector<glm::vec4> grid; // endpoints of the grid lines, in pairs
+};
+
+#endif /* SoftwareRenderer_h */
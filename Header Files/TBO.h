@@ -0,0 +1,33 @@
+//
+//  TBO.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/19/21.
+//
+
+#ifndef TBO_CLASS_h
+#define TBO_CLASS_h
+
+#include <glad/glad.h>
+
+// a buffer the shaders read as a samplerBuffer / isamplerBuffer with texelFetch; format is the
+// texel format (GL_R32F, GL_RG32I, ...). Holds the buffer and the buffer texture that views it.
+class TBO
+{
+public:
+    GLuint ID; // the buffer
+    GLuint texture; // the buffer texture
+    GLsizeiptr capacity;
+    GLenum usage;
+    TBO(const void* data, GLsizeiptr size, GLenum format, GLenum usage = GL_STATIC_DRAW);
+    
+    // replaces size bytes starting at offset, giving the driver fresh storage first when the whole buffer is rewritten
+    void Update(const void* data, GLsizeiptr size, GLintptr offset = 0);
+    
+    // binds the buffer texture to texture unit unit
+    void Bind(GLuint unit);
+    void Unbind(GLuint unit);
+    void Delete();
+};
+
+#endif /* TBO_h */
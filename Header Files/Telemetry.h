@@ -0,0 +1,81 @@
+//
+//  Telemetry.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/4/22.
+//
+
+#ifndef TELEMETRY_CLASS_h
+#define TELEMETRY_CLASS_h
+
+#include <stdio.h>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+#include "Robot.h"
+
+enum TelemetryFormat{
+    TELEMETRY_CSV, // non-finite values are written as nan / inf
+    TELEMETRY_NDJSON // non-finite values are written as null
+};
+
+enum TelemetryKind{
+    TELEMETRY_EVALUATION, // one robot/controller after its evaluation
+    TELEMETRY_GENERATION  // summary over a whole generation
+};
+
+struct TelemetryRecord{
+    int kind;
+    long generation;
+    long index; // robot within the generation, -1 for generation records
+    float fitness; // generation records: the best fitness
+    float mean_fitness; // generation records only
+    float displacement; // xy distance between Controller::start and Controller::end, 0 for generation records
+    long steps;
+    double wall_time; // seconds the evaluation or generation took
+    int cubes;
+    int masses;
+    int springs;
+};
+
+// streams TelemetryRecords to a CSV or NDJSON file from a background thread. Emit never waits on
+// the disk: records go into a fixed ring that the writer drains in batches (flushed at least every
+// quarter second), and when the ring is full the record is dropped and counted instead.
+class Telemetry
+{
+public:
+    std::atomic<long> emitted;
+    std::atomic<long> dropped;
+    std::atomic<long> written;
+
+    Telemetry(const char* filename, TelemetryFormat format, int capacity = 4096);
+    ~Telemetry();
+
+    bool IsOpen() const { return file != NULL; }
+    bool Emit(const TelemetryRecord &record);
+    // writes what is queued and stops the writer; called by the destructor too
+    void Close();
+
+    // fills displacement and the size fields from a robot whose controller has start and end set
+    static TelemetryRecord Evaluation(long generation, long index, const Robot &robot, const Controller &control, long steps, double wall_time);
+    static TelemetryRecord Generation(long generation, const std::vector<float> &fitness, long steps, double wall_time);
+
+private:
+    void Run();
+    void WriteRecord(const TelemetryRecord &record);
+
+    FILE* file;
+    TelemetryFormat format;
+    std::vector<TelemetryRecord> ring;
+    size_t head;
+    size_t count;
+    bool stopping;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::thread writer;
+};
+
+#endif /* Telemetry_h */
@@ -0,0 +1,48 @@
+//
+//  ThreadPool.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 11/27/21.
+//
+
+#ifndef THREADPOOL_CLASS_h
+#define THREADPOOL_CLASS_h
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// fixed set of workers that stay alive between calls, so the physics can fan out
+// several times per substep without paying for thread creation
+class ThreadPool
+{
+public:
+    typedef std::function<void(int begin, int end, int worker)> Body;
+
+    ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    int Size() const { return numThreads; }
+
+    // splits [0, n) into Size() contiguous chunks (some may be empty); chunk w always goes to
+    // worker w and the calling thread runs chunk 0. Returns once every chunk is done.
+    void ParallelFor(int n, const Body &body);
+
+private:
+    void Run(int worker);
+
+    int numThreads;
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable start;
+    std::condition_variable done;
+    const Body* job;
+    int jobSize;
+    int generation;
+    int pending;
+    bool stopping;
+};
+
+#endif /* ThreadPool_h */
@@ -0,0 +1,137 @@
+//
+//  Trajectory.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/26/21.
+//
+
+#ifndef TRAJECTORY_CLASS_h
+#define TRAJECTORY_CLASS_h
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <utility>
+
+#include "Robot.h"
+
+// Trajectory file layout (native byte order, everything 4-byte aligned):
+//
+//   TrajectoryHeader                     one page
+//   topology                             springCount x {int32 m0, int32 m1, float original_L0}, padded to a page
+//   chunk 0, chunk 1, ...                chunkBytes each (a multiple of the page size)
+//
+// A chunk holds framesPerChunk frames stored column by column: the T of every frame, then the
+// positions of every frame (massCount x 3 floats each), then the velocities and the spring
+// lengths Spring::L if the file has them. The last chunk is padded to full size, so frame f is
+// always at a fixed offset and the file can be mmapped and read by frame without an index.
+enum TrajectoryColumns
+{
+    TRAJECTORY_POSITIONS = 1,
+    TRAJECTORY_VELOCITIES = 2,
+    TRAJECTORY_SPRING_LENGTHS = 4
+};
+
+struct TrajectoryHeader{
+    char magic[8]; // "PSTRAJ" and two zero bytes
+    uint32_t version;
+    uint32_t columns; // TrajectoryColumns bits
+    uint32_t massCount;
+    uint32_t springCount;
+    uint32_t stride; // substeps between two frames
+    uint32_t framesPerChunk;
+    float dt; // seconds per substep
+    uint32_t pageSize; // alignment of the topology and the chunks
+    uint64_t frameCount; // frames written so far, rewritten after every chunk
+    uint64_t topologyOffset;
+    uint64_t chunkOffset; // where chunk 0 starts
+    uint64_t chunkBytes;
+};
+
+// where each column starts inside a chunk, in bytes
+struct TrajectoryLayout{
+    uint64_t time;
+    uint64_t positions;
+    uint64_t velocities;
+    uint64_t springLengths;
+    uint64_t chunkBytes;
+};
+
+TrajectoryLayout trajectory_layout(uint32_t columns, uint32_t massCount, uint32_t springCount, uint32_t framesPerChunk, uint32_t pageSize);
+
+// appends a frame every stride substeps. The simulation thread only copies into the current chunk;
+// full chunks are written by a background thread, so recording barely shows in the step rate.
+class TrajectoryRecorder
+{
+public:
+    TrajectoryHeader header;
+    TrajectoryLayout layout;
+
+    TrajectoryRecorder(const char* filename, const Robot &robot, int stride, uint32_t columns = TRAJECTORY_POSITIONS, int framesPerChunk = 256);
+    ~TrajectoryRecorder();
+
+    bool IsOpen() const { return file != NULL; }
+    // call after every substep with the number of substeps run so far; records when step is a multiple of stride
+    void Record(const Robot &robot, long step);
+    // writes the partial last chunk and the final frame count, then closes the file
+    void Close();
+
+private:
+    void Submit();
+    void Run();
+
+    FILE* file;
+    std::vector<char>* current; // chunk being filled
+    uint32_t framesInChunk;
+
+    std::deque<std::pair<std::vector<char>*, uint32_t> > pending; // chunks (and how many frames they hold) waiting for the writer
+    std::vector<std::vector<char>*> spare; // written chunks ready for reuse
+    std::mutex lock;
+    std::condition_variable wake;
+    bool stopping;
+    std::thread writer;
+};
+
+// read-only view of a trajectory file through mmap
+class TrajectoryReader
+{
+public:
+    TrajectoryHeader header;
+    TrajectoryLayout layout;
+
+    TrajectoryReader(const char* filename);
+    ~TrajectoryReader();
+
+    bool IsOpen() const { return data != NULL; }
+    long Frames() const { return (long)header.frameCount; }
+
+    // seconds of simulation between two frames
+    float FrameDuration() const { return header.stride*header.dt; }
+    // fills robot.masses (at frame 0) and robot.springs from the recorded topology, enough for the renderers
+    void Topology(Robot &robot) const;
+
+    int M0(int spring) const { return topology[3*spring+0]; }
+    int M1(int spring) const { return topology[3*spring+1]; }
+    float RestLength(int spring) const;
+
+    float Time(long frame) const;
+    // {x, y, z} per mass; NULL if the file has no such column
+    const float* Positions(long frame) const;
+    const float* Velocities(long frame) const;
+    // Spring::L per spring
+    const float* SpringLengths(long frame) const;
+
+private:
+    const char* Column(long frame, uint64_t column, uint64_t frameBytes) const;
+
+    const char* data;
+    size_t size;
+    const int32_t* topology;
+};
+
+#endif /* Trajectory_h */
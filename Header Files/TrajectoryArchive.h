@@ -0,0 +1,86 @@
+//
+//  TrajectoryArchive.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/6/22.
+//
+
+#ifndef TRAJECTORYARCHIVE_CLASS_h
+#define TRAJECTORYARCHIVE_CLASS_h
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+#include "Robot.h"
+
+#define ARCHIVE_VERSION 2
+
+// one gait in an archive file. The file is just these entries back to back, so appending the
+// elites of a new generation never rewrites what is already there; opening a writer only cuts off
+// a torn entry left at the end by a crash.
+struct ArchiveEntryHeader{
+    char magic[8]; // "PSARCH\0\0"
+    uint32_t version;
+    uint32_t massCount;
+    uint32_t springCount;
+    uint32_t frameCount;
+    uint32_t framesPerKey; // frames per independently decodable chunk
+    uint32_t keyCount;
+    int64_t generation;
+    int64_t member;
+    float frameDuration; // simulated seconds between frames
+    float errorBound; // no decoded coordinate is further than this from the original
+    double quantum; // grid spacing, a little under 2*errorBound to leave room for float rounding
+    uint64_t entryBytes; // whole entry including this header
+    uint64_t checksum; // fnv1a of the payload, so a torn or garbled entry is recognized
+};
+
+// lossy positions-only compression of a trajectory. Every framesPerKey frames a key frame stores
+// each coordinate quantized to a 2*errorBound grid anchored at the bounding box corner of that
+// frame; the frames after it store the change of the quantized value from the previous frame.
+// Both are written with adaptive Rice codes. Quantizing before taking differences keeps the error
+// bounded instead of letting it accumulate along the chunk.
+class ArchiveWriter
+{
+public:
+    float errorBound;
+    int framesPerKey;
+
+    ArchiveWriter(const char* filename, float errorBound = 1e-4f, int framesPerKey = 64);
+    ~ArchiveWriter();
+
+    bool IsOpen() const { return file != NULL; }
+    // positions holds frames*massCount {x, y, z}; springs of robot are stored so the entry can be drawn alone.
+    // Returns the size of the entry in bytes, 0 on failure.
+    size_t Append(long generation, long member, const Robot &robot, const float* positions, int frames, float frameDuration);
+    void Close();
+
+private:
+    FILE* file;
+};
+
+class ArchiveReader
+{
+public:
+    ArchiveReader(const char* filename);
+    ~ArchiveReader();
+
+    bool IsOpen() const { return data != NULL; }
+    int Entries() const { return (int)entries.size(); }
+    const ArchiveEntryHeader& Entry(int entry) const { return headers[entry]; }
+
+    // fills robot.masses (at frame 0) and robot.springs from the stored topology, enough for the renderers
+    void Topology(int entry, Robot &robot) const;
+    // decodes count frames starting at first into out (count*massCount*3 floats); starts at the nearest key frame
+    bool Decode(int entry, long first, long count, float* out) const;
+    bool Decode(int entry, std::vector<float> &positions) const;
+
+private:
+    const char* data;
+    size_t size;
+    std::vector<size_t> entries; // offset of every entry header
+    std::vector<ArchiveEntryHeader> headers; // aligned copies, entries in the file are not 8 byte aligned
+};
+
+#endif /* TrajectoryArchive_h */
@@ -0,0 +1,57 @@
+//
+//  TripleBuffer.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/11/21.
+//
+
+#ifndef TRIPLEBUFFER_CLASS_h
+#define TRIPLEBUFFER_CLASS_h
+
+#include <atomic>
+
+// single producer / single consumer hand-off without locks: the writer fills Back() and
+// publishes it, the reader picks up the newest published slot with Acquire(). Neither side
+// ever waits; a reader that is slower than the writer simply skips the snapshots in between.
+template <typename T>
+class TripleBuffer
+{
+public:
+    T slots[3]; // size these before the threads start
+
+    TripleBuffer()
+    {
+        back = 0;
+        middle = 1;
+        front = 2;
+    }
+
+    // writer side
+    T& Back() { return slots[back]; }
+    void Publish()
+    {
+        //hand the filled slot over and take back whatever the reader left in the middle
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // reader side; returns false (and keeps the old front) when nothing new was published
+    bool Acquire()
+    {
+        if (!(middle.load(std::memory_order_acquire) & FRESH)){
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+    const T& Front() const { return slots[front]; }
+
+private:
+    static const int INDEX = 3;
+    static const int FRESH = 4;
+
+    int back; // only touched by the writer
+    std::atomic<int> middle; // slot index, plus FRESH when the writer published since the last Acquire
+    int front; // only touched by the reader
+};
+
+#endif /* TripleBuffer_h */
@@ -0,0 +1,34 @@
+//
+//  UBO.h
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/5/21.
+//
+
+#ifndef UBO_CLASS_h
+#define UBO_CLASS_h
+
+#include <glad/glad.h>
+
+// binding points shared by every program that declares the matching block
+#define CAMERA_BLOCK_BINDING 0
+
+// a uniform buffer attached to one binding point, so several programs read the same data
+// (the layout on the shader side is std140)
+class UBO
+{
+public:
+    GLuint ID;
+    GLuint binding;
+    GLsizeiptr capacity;
+    UBO(GLsizeiptr size, GLuint binding);
+    
+    // replaces size bytes starting at offset; binds the buffer itself
+    void Update(const void* data, GLsizeiptr size, GLintptr offset = 0);
+    
+    void Bind();
+    void Unbind();
+    void Delete();
+};
+
+#endif /* UBO_h */
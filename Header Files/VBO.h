@@ -14,7 +14,16 @@ class VBO
 {
 public:
     GLuint ID;
+    GLsizeiptr capacity;
+    GLenum usage;
     VBO(GLfloat* vertices, GLsizeiptr size);
+    // allocates size bytes without data, for buffers that are rewritten with Update (usage is usually GL_DYNAMIC_DRAW or GL_STREAM_DRAW)
+    VBO(GLsizeiptr size, GLenum usage);
+    
+    // replaces size bytes starting at offset; the buffer has to be bound
+    void Update(GLfloat* vertices, GLsizeiptr size, GLintptr offset = 0);
+    // gives the driver fresh storage of the same size, so the next Update does not wait on a frame the GPU is still drawing
+    void Orphan();
     
     void Bind();
     void Unbind();
@@ -14,17 +14,50 @@
 #include <sstream>
 #include <iostream>
 #include <cerrno>
+#include <unordered_map>
+#include <map>
+#include <utility>
+#include <glm/glm.hpp>
 
 std::string get_file_contents(const char* filename);
 
 class Shader
 {
     public:
-        GLuint ID;
+        GLuint ID; // 0 when the sources never compiled; errors are logged
+        // active uniform locations, read back once after linking
+        std::unordered_map<std::string, GLint> uniforms;
+        std::string vertexFile;
+        std::string fragmentFile;
+        // linked programs are cached in ShaderCache/ by a hash of the sources and the driver, so
+        // later launches skip compiling (when the driver supports program binaries)
         Shader(const char* vertexFile, const char* fragmentFile);
     
         void Activate();
         void Delete();
+    
+        // builds the program again from the files; if they do not compile or link, the errors are
+        // logged and the old program stays in use. Returns true when the program was replaced, in
+        // which case uniforms outside blocks (samplers etc.) have to be set again
+        bool Reload();
+        // Reload, but only if either file changed on disk since the last build
+        bool ReloadIfChanged();
+    
+        // -1 for names the linker dropped or that live in a uniform block, which glUniform* ignores
+        GLint UniformLocation(const std::string &name) const;
+        // the setters write to the current program, so call Activate first
+        void setMat4(const std::string &name, const glm::mat4 &value) const;
+        void setFloat(const std::string &name, float value) const;
+        void setInt(const std::string &name, int value) const;
+        // attaches the named uniform block (if the program has one) to a UBO binding point
+        void BindUniformBlock(const char* name, GLuint binding);
+    
+    private:
+        void CacheUniforms();
+    
+        std::map<std::string, GLuint> blockBindings; // reapplied after a reload
+        std::pair<long, long> vertexStamp; // modification time and size when last read
+        std::pair<long, long> fragmentStamp;
 };
 
 #endif /* shaderClass_h */
@@ -0,0 +1,94 @@
+//
+//  Logger.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 11/14/21.
+//
+
+#include <stdio.h>
+#include <iostream>
+#include "Logger.h"
+
+static const char* level_names[] = {"TRACE", "DEBUG", "INFO", "WARN", "ERROR"};
+
+Logger& Logger::Get()
+{
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+{
+    minLevel = LOG_LEVEL_INFO;
+    stopping = false;
+    writing = false;
+    writer = std::thread(&Logger::Run, this);
+}
+
+Logger::~Logger()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+void Logger::SetLevel(int level)
+{
+    minLevel = level;
+}
+
+void Logger::Write(int level, const std::string &message)
+{
+    std::string line = "[";
+    line += level_names[level];
+    line += "] ";
+    line += message;
+    line += '\n';
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        queue.push_back(line);
+    }
+    wake.notify_one();
+
+    if (level >= LOG_LEVEL_ERROR){
+        Flush();
+    }
+}
+
+void Logger::Flush()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    drained.wait(guard, [this]{ return queue.empty() && !writing; });
+}
+
+void Logger::Run()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    while (true){
+        wake.wait(guard, [this]{ return stopping || !queue.empty(); });
+
+        //take the whole batch so producers never wait on the terminal
+        std::deque<std::string> batch;
+        batch.swap(queue);
+        writing = true;
+        guard.unlock();
+
+        std::string out;
+        for (int i=0; i<batch.size(); i++){
+            out += batch[i];
+        }
+        std::cout << out << std::flush;
+
+        guard.lock();
+        writing = false;
+        if (queue.empty()){
+            drained.notify_all();
+            if (stopping){
+                break;
+            }
+        }
+    }
+}
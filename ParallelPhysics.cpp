@@ -0,0 +1,159 @@
+//
+//  ParallelPhysics.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 11/27/21.
+//
+
+#include <stdio.h>
+#include "ParallelPhysics.h"
+#include "Profile.h"
+using namespace std;
+
+ParallelPhysics::ParallelPhysics(int num_threads, ReductionMode mode) : pool(num_threads)
+{
+    this->mode = mode;
+}
+
+void ParallelPhysics::Prepare(const Robot &robot)
+{
+    int num_masses = (int)robot.masses.size();
+    int num_springs = (int)robot.springs.size();
+    
+    springStart.assign(num_masses+1, 0);
+    for (int i=0; i<num_springs; i++){
+        springStart[robot.springs[i].m0+1] += 1;
+        springStart[robot.springs[i].m1+1] += 1;
+    }
+    for (int m=0; m<num_masses; m++){
+        springStart[m+1] += springStart[m];
+    }
+    
+    //walking the springs in order keeps every mass's list ascending, which is the order update_forces adds them in
+    springList.resize(2*num_springs);
+    vector<int> fill(springStart.begin(), springStart.end()-1);
+    for (int i=0; i<num_springs; i++){
+        springList[fill[robot.springs[i].m0]++] = i;
+        springList[fill[robot.springs[i].m1]++] = -i-1;
+    }
+    
+    springForce.assign(3*num_springs, 0.0f);
+    partial.assign(pool.Size(), vector<float>(3*num_masses, 0.0f));
+}
+
+void ParallelPhysics::SpringForces(Robot &robot, int begin, int end, int worker)
+{
+    if (mode == REDUCTION_DETERMINISTIC){
+        for (int i=begin; i<end; i++){
+            float direction[3];
+            float force = spring_force(robot, i, direction);
+            for (int n=0; n<3; n++){
+                springForce[3*i+n] = force * direction[n];
+            }
+        }
+        return;
+    }
+    
+    vector<float> &forces = partial[worker];
+    fill(forces.begin(), forces.end(), 0.0f);
+    for (int i=begin; i<end; i++){
+        int p0 = robot.springs[i].m0;
+        int p1 = robot.springs[i].m1;
+        float direction[3];
+        float force = spring_force(robot, i, direction);
+        for (int n=0; n<3; n++){
+            forces[3*p0+n] += force * direction[n];
+            forces[3*p1+n] += force * -direction[n];
+        }
+    }
+}
+
+void ParallelPhysics::ExternalForces(Robot &robot, int begin, int end)
+{
+    int workers = pool.Size();
+    for (int m=begin; m<end; m++){
+        vector<float> &forces = robot.masses[m].forces;
+        if (mode == REDUCTION_DETERMINISTIC){
+            for (int k=springStart[m]; k<springStart[m+1]; k++){
+                int id = springList[k];
+                for (int n=0; n<3; n++){
+                    if (id >= 0){
+                        forces[n] = forces[n] + springForce[3*id+n];
+                    }
+                    else{
+                        forces[n] = forces[n] + -springForce[3*(-id-1)+n];
+                    }
+                }
+            }
+        }
+        else{
+            for (int w=0; w<workers; w++){
+                for (int n=0; n<3; n++){
+                    forces[n] = forces[n] + partial[w][3*m+n];
+                }
+            }
+        }
+        apply_external_forces(robot.masses[m]);
+    }
+}
+
+void ParallelPhysics::UpdateForces(Robot &robot)
+{
+    if (springStart.size() != robot.masses.size()+1 || springList.size() != 2*robot.springs.size()){
+        Prepare(robot);
+    }
+    
+    {
+        PROFILE_SCOPE(PHASE_SPRINGS);
+        pool.ParallelFor((int)robot.springs.size(), [this, &robot](int begin, int end, int worker){
+            SpringForces(robot, begin, end, worker);
+        });
+    }
+    {
+        PROFILE_SCOPE(PHASE_EXTERNAL);
+        pool.ParallelFor((int)robot.masses.size(), [this, &robot](int begin, int end, int /*worker*/){
+            ExternalForces(robot, begin, end);
+        });
+    }
+}
+
+void ParallelPhysics::UpdatePosVelAcc(Robot &robot)
+{
+    {
+        PROFILE_SCOPE(PHASE_INTEGRATION);
+        pool.ParallelFor((int)robot.masses.size(), [&robot](int begin, int end, int /*worker*/){
+            for (int i=begin; i<end; i++){
+                integrate_mass(robot.masses[i]);
+            }
+        });
+    }
+    {
+        PROFILE_SCOPE(PHASE_CUBE_SYNC);
+        pool.ParallelFor((int)robot.all_cubes.size(), [&robot](int begin, int end, int /*worker*/){
+            for (int j=begin; j<end; j++){
+                sync_cube(robot, j);
+            }
+        });
+    }
+}
+
+void ParallelPhysics::ResetForces(Robot &robot)
+{
+    pool.ParallelFor((int)robot.masses.size(), [&robot](int begin, int end, int /*worker*/){
+        for (int i=begin; i<end; i++){
+            robot.masses[i].forces = {0.0f, 0.0f, 0.0f};
+        }
+    });
+}
+
+void ParallelPhysics::Step(Robot &robot, Controller &control)
+{
+    T = T + dt;
+    //breathing stays serial: neighbouring cubes share springs and the last writer has to stay the same
+    if (breathing) {
+        update_breathing(robot, control);
+    }
+    UpdateForces(robot);
+    UpdatePosVelAcc(robot);
+    ResetForces(robot);
+}
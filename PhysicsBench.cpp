@@ -0,0 +1,158 @@
+//
+//  PhysicsBench.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 11/27/21.
+//
+//  Compares the serial step with ParallelPhysics in both reduction modes: steps/s for each,
+//  and whether the trajectories match the serial one bit for bit.
+//  Usage: PhysicsBench [cubes] [steps] [max threads]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "Robot.h"
+#include "ParallelPhysics.h"
+#include "Trajectory.h"
+#include "Energy.h"
+using namespace std;
+
+static void make_robot(Robot &robot, Controller &control, int num_cubes){
+    Rng rng(2021);
+    initialize_robot(robot, num_cubes, rng);
+    reorder_robot(robot, false);
+    randomize_controller(control, num_cubes, rng);
+    T = 0.0;
+}
+
+static void serial_step(Robot &robot, Controller &control, EnergySample *energy = NULL){
+    T = T + dt;
+    if (breathing) {
+        update_breathing(robot, control);
+    }
+    update_forces(robot, energy);
+    update_pos_vel_acc(robot);
+    reset_forces(robot);
+}
+
+static vector<float> positions(const Robot &robot){
+    vector<float> out;
+    for (int m=0; m<robot.masses.size(); m++){
+        out.insert(out.end(), robot.masses[m].position.begin(), robot.masses[m].position.end());
+    }
+    return out;
+}
+
+static float max_difference(const vector<float> &a, const vector<float> &b){
+    float diff = 0;
+    for (int i=0; i<a.size(); i++){
+        diff = max(diff, fabsf(a[i]-b[i]));
+    }
+    return diff;
+}
+
+int main(int argc, const char * argv[]) {
+    int num_cubes = argc > 1 ? atoi(argv[1]) : 200;
+    int steps = argc > 2 ? atoi(argv[2]) : 2000;
+    int max_threads = argc > 3 ? atoi(argv[3]) : max((int)thread::hardware_concurrency(), 1);
+    breathing = true;
+
+    Robot robot;
+    Controller control;
+    make_robot(robot, control, num_cubes);
+    printf("%d cubes, %zu masses, %zu springs, %d steps\n", num_cubes, robot.masses.size(), robot.springs.size(), steps);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int s=0; s<steps; s++){
+        serial_step(robot, control);
+    }
+    double serial_time = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+    vector<float> reference = positions(robot);
+    printf("%-14s %8s %12s %14s\n", "mode", "threads", "steps/s", "max |dx|");
+    printf("%-14s %8d %12.1f %14s\n", "serial", 1, steps/serial_time, "reference");
+
+    //same run again while recording positions and spring lengths every 10th substep, to see what the recorder costs
+    const char* trajectory_file = "PhysicsBench.traj";
+    make_robot(robot, control, num_cubes);
+    TrajectoryRecorder* recorder = new TrajectoryRecorder(trajectory_file, robot, 10, TRAJECTORY_POSITIONS | TRAJECTORY_SPRING_LENGTHS);
+    start = chrono::steady_clock::now();
+    recorder->Record(robot, 0);
+    for (int s=0; s<steps; s++){
+        serial_step(robot, control);
+        recorder->Record(robot, s+1);
+    }
+    double recorded_time = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+    recorder->Close();
+    delete recorder;
+    {
+        TrajectoryReader reader(trajectory_file);
+        vector<float> result = positions(robot);
+        bool matches = reader.IsOpen() && reader.Frames() == steps/10+1 && memcmp(reader.Positions(reader.Frames()-1), result.data(), result.size()*sizeof(float)) == 0;
+        char note[32];
+        snprintf(note, sizeof(note), "%+.1f%% %s", (recorded_time/serial_time-1)*100, matches ? "ok" : "MISMATCH");
+        printf("%-14s %8d %12.1f %14s\n", "recorded", 1, steps/recorded_time, note);
+    }
+    remove(trajectory_file);
+
+    //energy summed inside update_forces, on every substep (worst case) and on every 100th
+    const int intervals[] = {1, 100};
+    for (int e=0; e<2; e++){
+        make_robot(robot, control, num_cubes);
+        EnergyLog energy(1024, intervals[e]);
+        start = chrono::steady_clock::now();
+        for (int s=0; s<steps; s++){
+            serial_step(robot, control, energy.Sample(s));
+        }
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+        vector<float> result = positions(robot);
+        bool identical = memcmp(result.data(), reference.data(), result.size()*sizeof(float)) == 0;
+        char name[32];
+        char note[32];
+        snprintf(name, sizeof(name), "energy/%d", intervals[e]);
+        snprintf(note, sizeof(note), "%+.1f%% %s", (elapsed/serial_time-1)*100, identical ? "ok" : "MISMATCH");
+        printf("%-14s %8d %12.1f %14s\n", name, 1, steps/elapsed, note);
+    }
+
+    const char* names[] = {"fast", "deterministic"};
+    for (int threads=1; threads<=max_threads; threads*=2){
+        for (int mode=REDUCTION_FAST; mode<=REDUCTION_DETERMINISTIC; mode++){
+            make_robot(robot, control, num_cubes);
+            ParallelPhysics physics(threads, (ReductionMode)mode);
+            physics.Prepare(robot);
+
+            start = chrono::steady_clock::now();
+            for (int s=0; s<steps; s++){
+                physics.Step(robot, control);
+            }
+            double elapsed = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+
+            vector<float> result = positions(robot);
+            bool identical = memcmp(result.data(), reference.data(), result.size()*sizeof(float)) == 0;
+            char diff[32];
+            if (identical){
+                snprintf(diff, sizeof(diff), "bit-identical");
+            }
+            else{
+                snprintf(diff, sizeof(diff), "%.3g", max_difference(result, reference));
+            }
+            printf("%-14s %8d %12.1f %14s\n", names[mode], threads, steps/elapsed, diff);
+        }
+    }
+
+    //without breathing nothing feeds energy in, so the total should only fall (friction, ground contact)
+    breathing = false;
+    make_robot(robot, control, num_cubes);
+    EnergyLog energy(1024, max(steps/100, 1));
+    for (int s=0; s<=steps; s++){
+        serial_step(robot, control, energy.Sample(s));
+    }
+    printf("energy without breathing: %.4f J -> %.4f J over %d steps (%+.3f%%)\n", energy[0].Total(), energy.Newest().Total(), steps, energy.Drift()*100);
+
+    return 0;
+}
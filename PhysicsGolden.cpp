@@ -0,0 +1,244 @@
+//
+//  PhysicsGolden.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/9/22.
+//
+//  Golden-trajectory regression check for the physics kernels. "record" saves the starting state
+//  as a checkpoint and runs the reference serial step, storing positions and velocities every
+//  stride substeps. "check" restarts every backend from that checkpoint and compares each stored
+//  frame: backends that promise bit-identical results must match exactly, the others within
+//  |a-b| <= abs + rel*|b|. Between stored frames the backend is checked against the reference step
+//  restarted from the previous frame, so the first substep, mass and coordinate outside that is
+//  reported even when it falls between frames (this runs the reference alongside every backend).
+//  Backends that sum forces in another order drift apart chaotically, roughly tenfold per
+//  thousand substeps here, so keep the horizon short (the default 2000) when checking those.
+//  Usage: PhysicsGolden record <name> [cubes] [steps] [stride] [seed]
+//         PhysicsGolden check <name> [abs tolerance] [rel tolerance] [max threads]
+//  writes / reads <name>.ckpt and <name>.traj; check exits with 1 if any backend diverges.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Robot.h"
+#include "ParallelPhysics.h"
+#include "Checkpoint.h"
+#include "Trajectory.h"
+#include "Logger.h"
+using namespace std;
+
+// a way of advancing the robot by one substep; new kernels (SIMD, other layouts) get added to backends()
+struct Backend{
+    string name;
+    bool exact; // must reproduce the reference bit for bit
+    function<void(Robot&, Controller&)> step;
+};
+
+static void reference_step(Robot &robot, Controller &control){
+    T = T + dt;
+    if (breathing) {
+        update_breathing(robot, control);
+    }
+    update_forces(robot);
+    update_pos_vel_acc(robot);
+    reset_forces(robot);
+}
+
+static vector<Backend> backends(int max_threads){
+    vector<Backend> list;
+    list.push_back({"reference", true, reference_step});
+    list.push_back({"fused energy", true, [](Robot &robot, Controller &control){
+        EnergySample energy;
+        T = T + dt;
+        if (breathing) {
+            update_breathing(robot, control);
+        }
+        update_forces(robot, &energy);
+        update_pos_vel_acc(robot);
+        reset_forces(robot);
+    }});
+    for (int threads=1; threads<=max_threads; threads*=2){
+        for (int mode=REDUCTION_FAST; mode<=REDUCTION_DETERMINISTIC; mode++){
+            shared_ptr<ParallelPhysics> physics = make_shared<ParallelPhysics>(threads, (ReductionMode)mode);
+            string name = string(mode == REDUCTION_FAST ? "parallel fast " : "parallel deterministic ") + to_string(threads);
+            list.push_back({name, mode == REDUCTION_DETERMINISTIC, [physics](Robot &robot, Controller &control){
+                physics->Step(robot, control);
+            }});
+        }
+    }
+    return list;
+}
+
+static int record(const string &name, int num_cubes, int steps, int stride, uint64_t seed){
+    Checkpoint start;
+    Rng rng(seed);
+    initialize_robot(start.robot, num_cubes, rng);
+    reorder_robot(start.robot, false);
+    randomize_controller(start.control, num_cubes, rng);
+    T = 0;
+    breathing = true;
+    capture_globals(start);
+    start.rng = rng;
+    start.generation = 0;
+    if (!save_checkpoint((name + ".ckpt").c_str(), start)){
+        return 1;
+    }
+
+    Robot robot = start.robot;
+    Controller control = start.control;
+    TrajectoryRecorder recorder((name + ".traj").c_str(), robot, stride, TRAJECTORY_POSITIONS | TRAJECTORY_VELOCITIES);
+    if (!recorder.IsOpen()){
+        return 1;
+    }
+    recorder.Record(robot, 0);
+    for (int s=0; s<steps; s++){
+        reference_step(robot, control);
+        recorder.Record(robot, s+1);
+    }
+    recorder.Close();
+    printf("recorded %d cubes, %zu masses, %d steps (%llu frames) to %s.traj\n", num_cubes, robot.masses.size(), steps, (unsigned long long)recorder.header.frameCount, name.c_str());
+    return 0;
+}
+
+struct Divergence{
+    bool found;
+    long step;
+    int mass;
+    int axis;
+    const char* column;
+    float expected;
+    float actual;
+};
+
+//first value of robot that is not within tolerance of the stored frame
+static Divergence compare(const Robot &robot, const float* positions, const float* velocities, double abs_tolerance, double rel_tolerance, double &worst){
+    Divergence divergence = {false, 0, 0, 0, "", 0, 0};
+    for (int m=0; m<robot.masses.size(); m++){
+        for (int n=0; n<3; n++){
+            const float expected[2] = {positions[3*m+n], velocities[3*m+n]};
+            const float actual[2] = {robot.masses[m].position[n], robot.masses[m].velocity[n]};
+            for (int c=0; c<2; c++){
+                double diff = fabs((double)actual[c] - expected[c]);
+                worst = max(worst, diff);
+                //written so that NaN on either side counts as diverged
+                if (!(diff <= abs_tolerance + rel_tolerance*fabs(expected[c])) && !divergence.found){
+                    divergence = {true, 0, m, n, c == 0 ? "position" : "velocity", expected[c], actual[c]};
+                }
+            }
+        }
+    }
+    return divergence;
+}
+
+//overwrites the masses of robot with a stored frame
+static void load_frame(Robot &robot, const float* positions, const float* velocities){
+    for (int m=0; m<robot.masses.size(); m++){
+        for (int n=0; n<3; n++){
+            robot.masses[m].position[n] = positions[3*m+n];
+            robot.masses[m].velocity[n] = velocities[3*m+n];
+        }
+    }
+}
+
+//the masses of robot as frame arrays, so a live robot can be compared like a stored frame
+static void save_frame(const Robot &robot, vector<float> &positions, vector<float> &velocities){
+    for (int m=0; m<robot.masses.size(); m++){
+        for (int n=0; n<3; n++){
+            positions[3*m+n] = robot.masses[m].position[n];
+            velocities[3*m+n] = robot.masses[m].velocity[n];
+        }
+    }
+}
+
+static int check(const string &name, double abs_tolerance, double rel_tolerance, int max_threads){
+    Checkpoint start;
+    if (!load_checkpoint((name + ".ckpt").c_str(), start)){
+        return 1;
+    }
+    TrajectoryReader golden((name + ".traj").c_str());
+    if (!golden.IsOpen() || golden.Frames() == 0 || golden.Velocities(0) == NULL || golden.header.massCount != start.robot.masses.size()){
+        LOG_ERROR(name << ".traj does not hold positions and velocities for the checkpointed robot");
+        return 1;
+    }
+    long stride = golden.header.stride;
+    printf("%ld frames every %ld substeps, %zu masses, tolerance %g + %g*|x|\n", golden.Frames(), stride, start.robot.masses.size(), abs_tolerance, rel_tolerance);
+    printf("%-26s %8s %12s  %s\n", "backend", "expects", "max |diff|", "result");
+
+    int failures = 0;
+    vector<Backend> list = backends(max_threads);
+    for (int b=0; b<list.size(); b++){
+        Robot robot = start.robot;
+        Controller control = start.control;
+        restore_globals(start);
+        double worst = 0;
+        double tolerance = list[b].exact ? 0 : abs_tolerance;
+        double relative = list[b].exact ? 0 : rel_tolerance;
+
+        //the substeps between stored frames are checked against a reference robot restarted from the
+        //golden state at every frame (only positions and velocities carry over between substeps)
+        Robot expected = start.robot;
+        Controller expected_control = start.control;
+        vector<float> positions(3*robot.masses.size());
+        vector<float> velocities(3*robot.masses.size());
+
+        Divergence divergence = compare(robot, golden.Positions(0), golden.Velocities(0), tolerance, relative, worst);
+        for (long f=1; f<golden.Frames() && !divergence.found; f++){
+            load_frame(expected, golden.Positions(f-1), golden.Velocities(f-1));
+            for (long s=0; s<stride && !divergence.found; s++){
+                double time = T;
+                list[b].step(robot, control);
+                if (s+1 < stride){
+                    T = time;
+                    reference_step(expected, expected_control);
+                    save_frame(expected, positions, velocities);
+                    divergence = compare(robot, positions.data(), velocities.data(), tolerance, relative, worst);
+                    divergence.step = (f-1)*stride + s+1;
+                }
+            }
+            if (!divergence.found){
+                divergence = compare(robot, golden.Positions(f), golden.Velocities(f), tolerance, relative, worst);
+                divergence.step = f*stride;
+            }
+        }
+
+        char result[160];
+        if (divergence.found){
+            const char* axes = "xyz";
+            snprintf(result, sizeof(result), "DIVERGED at step %ld, mass %d %s.%c: expected %.9g, got %.9g", divergence.step, divergence.mass, divergence.column, axes[divergence.axis], divergence.expected, divergence.actual);
+            failures++;
+        }
+        else{
+            snprintf(result, sizeof(result), "%s", worst == 0 ? "ok, bit-identical" : "ok");
+        }
+        printf("%-26s %8s %12.3g  %s\n", list[b].name.c_str(), list[b].exact ? "exact" : "close", worst, result);
+    }
+    return failures > 0 ? 1 : 0;
+}
+
+int main(int argc, const char * argv[]) {
+    if (argc < 3 || (strcmp(argv[1], "record") != 0 && strcmp(argv[1], "check") != 0)){
+        fprintf(stderr, "Usage: PhysicsGolden record <name> [cubes] [steps] [stride] [seed]\n");
+        fprintf(stderr, "       PhysicsGolden check <name> [abs tolerance] [rel tolerance] [max threads]\n");
+        return 1;
+    }
+    string name = argv[2];
+    if (strcmp(argv[1], "record") == 0){
+        int num_cubes = argc > 3 ? atoi(argv[3]) : 50;
+        int steps = argc > 4 ? atoi(argv[4]) : 2000;
+        int stride = argc > 5 ? atoi(argv[5]) : 10;
+        uint64_t seed = argc > 6 ? strtoull(argv[6], NULL, 10) : 2022;
+        return record(name, num_cubes, max(steps, 1), max(stride, 1), seed);
+    }
+    double abs_tolerance = argc > 3 ? atof(argv[3]) : 1e-3;
+    double rel_tolerance = argc > 4 ? atof(argv[4]) : 1e-3;
+    int max_threads = argc > 5 ? atoi(argv[5]) : max((int)thread::hardware_concurrency(), 2);
+    return check(name, abs_tolerance, rel_tolerance, max(max_threads, 1));
+}
@@ -0,0 +1,40 @@
+//
+//  Population.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 11/20/21.
+//
+
+#include <stdio.h>
+#include <thread>
+#include "Population.h"
+using namespace std;
+
+static void build_slice(vector<Robot> &population, int first, int stride, int num_cubes, uint64_t seed){
+    for (int i=first; i<population.size(); i+=stride){
+        //each robot draws from its own stream, so the result does not depend on the thread count
+        Rng rng = Rng::Stream(seed, i);
+        initialize_robot(population[i], num_cubes, rng);
+        reorder_robot(population[i], false);
+    }
+}
+
+void build_population(vector<Robot> &population, int population_size, int num_cubes, uint64_t seed, int num_threads){
+    if (num_threads <= 0){
+        num_threads = max((int)thread::hardware_concurrency(), 1);
+    }
+    num_threads = min(num_threads, max(population_size, 1));
+    
+    population.clear();
+    population.resize(population_size);
+    
+    //robots are handed out round robin so every thread gets a similar mix of easy and hard placements
+    vector<thread> workers;
+    for (int t=1; t<num_threads; t++){
+        workers.push_back(thread(build_slice, ref(population), t, num_threads, num_cubes, seed));
+    }
+    build_slice(population, 0, num_threads, num_cubes, seed);
+    for (int t=0; t<workers.size(); t++){
+        workers[t].join();
+    }
+}
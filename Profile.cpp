@@ -0,0 +1,127 @@
+//
+//  Profile.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/8/22.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include "Profile.h"
+#include "Logger.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+using namespace std;
+
+static const char* phase_names[] = {"actuation", "springs", "external forces", "integration", "cube sync", "render upload"};
+static const char* event_names[] = {"contacts", "static friction", "kinetic friction"};
+
+Profiler& Profiler::Get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+{
+    memset(&last, 0, sizeof(last));
+    startTicks = Ticks();
+    startTime = chrono::steady_clock::now();
+    lastDump = startTime;
+}
+
+uint64_t Profiler::Ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+ProfileCounters* Profiler::Register()
+{
+    ProfileCounters* counters = new ProfileCounters();
+    for (int p=0; p<PHASE_COUNT; p++){
+        counters->ticks[p] = 0;
+        counters->calls[p] = 0;
+    }
+    for (int e=0; e<EVENT_COUNT; e++){
+        counters->events[e] = 0;
+    }
+    lock_guard<mutex> guard(lock);
+    threads.push_back(unique_ptr<ProfileCounters>(counters));
+    return counters;
+}
+
+ProfileTotals Profiler::Totals()
+{
+    ProfileTotals totals;
+    memset(&totals, 0, sizeof(totals));
+    lock_guard<mutex> guard(lock);
+    for (int t=0; t<threads.size(); t++){
+        for (int p=0; p<PHASE_COUNT; p++){
+            totals.ticks[p] += threads[t]->ticks[p].load(memory_order_relaxed);
+            totals.calls[p] += threads[t]->calls[p].load(memory_order_relaxed);
+        }
+        for (int e=0; e<EVENT_COUNT; e++){
+            totals.events[e] += threads[t]->events[e].load(memory_order_relaxed);
+        }
+    }
+    return totals;
+}
+
+//the tick rate measured against steady_clock since startup, 1e9 when the ticks are nanoseconds already
+double Profiler::TicksPerSecond()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    return seconds > 0 ? (Ticks() - startTicks)/seconds : 1e9;
+#else
+    return 1e9;
+#endif
+}
+
+string Profiler::Summary()
+{
+    ProfileTotals totals = Totals();
+    double ticksPerSecond = TicksPerSecond();
+    uint64_t ticks[PHASE_COUNT];
+    uint64_t all = 0;
+    for (int p=0; p<PHASE_COUNT; p++){
+        ticks[p] = totals.ticks[p] - last.ticks[p];
+        all += ticks[p];
+    }
+
+    string out = "Profile:";
+    char line[160];
+    for (int p=0; p<PHASE_COUNT; p++){
+        uint64_t calls = totals.calls[p] - last.calls[p];
+        if (calls == 0){
+            continue;
+        }
+        snprintf(line, sizeof(line), "\n  %-16s %10.2f ms %6.1f%% %12.0f ns/call %10llu calls", phase_names[p], ticks[p]/ticksPerSecond*1e3, all > 0 ? 100.0*ticks[p]/all : 0.0, ticks[p]/ticksPerSecond*1e9/calls, (unsigned long long)calls);
+        out += line;
+    }
+    //external forces runs once per robot per substep (update_forces or ParallelPhysics::Step), so a
+    //gallery of n robots makes n calls a substep; events are reported per robot step
+    uint64_t robot_steps = totals.calls[PHASE_EXTERNAL] - last.calls[PHASE_EXTERNAL];
+    for (int e=0; e<EVENT_COUNT; e++){
+        uint64_t count = totals.events[e] - last.events[e];
+        snprintf(line, sizeof(line), "\n  %-16s %12llu %10.1f/robot step", event_names[e], (unsigned long long)count, robot_steps > 0 ? (double)count/robot_steps : 0.0);
+        out += line;
+    }
+    last = totals;
+    return out;
+}
+
+void Profiler::DumpEvery(double seconds)
+{
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    if (chrono::duration<double>(now - lastDump).count() < seconds){
+        return;
+    }
+    lastDump = now;
+    LOG_INFO(Summary());
+}
@@ -7,8 +7,13 @@ out vec3 color;
 uniform float scale;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 proj;
+
+// shared by every program through the UBO at CAMERA_BLOCK_BINDING
+layout (std140) uniform Camera
+{
+    mat4 view;
+    mat4 proj;
+};
 //uniform mat4 camMatrix;
 
 void main()
@@ -0,0 +1,31 @@
+#version 330 core
+// one instance per robot of a morphology: spring gl_VertexID/2 of robot gl_InstanceID, moved
+// into the robot's cell and colored by its fitness
+
+layout (location = 2) in vec3 aOffset; // per instance
+layout (location = 3) in vec3 aColor; // per instance
+
+out vec3 color;
+
+uniform samplerBuffer positions; // x, y, z of every mass of every instance, instance after instance
+uniform isamplerBuffer springs; // m0, m1 of every spring, shared by the instances
+uniform int massCount; // masses per instance
+
+uniform mat4 model;
+
+// shared by every program through the UBO at CAMERA_BLOCK_BINDING
+layout (std140) uniform Camera
+{
+    mat4 view;
+    mat4 proj;
+};
+
+void main()
+{
+    ivec2 ends = texelFetch(springs, gl_VertexID/2).rg;
+    int m = gl_InstanceID*massCount + (gl_VertexID%2 == 0 ? ends.x : ends.y);
+    vec3 p = vec3(texelFetch(positions, 3*m).r, texelFetch(positions, 3*m+1).r, texelFetch(positions, 3*m+2).r);
+    
+    color = aColor;
+    gl_Position = proj*view*model*vec4(p + aOffset, 1.0);
+}
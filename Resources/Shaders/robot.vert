@@ -0,0 +1,43 @@
+#version 330 core
+// draws spring gl_VertexID/2 with no vertex attributes: both ends are looked up in buffer
+// textures and the line is colored by its strain, so the CPU only uploads mass positions
+
+out vec3 color;
+
+uniform samplerBuffer positions; // x, y, z of every mass, one float per texel
+uniform isamplerBuffer springs; // m0, m1 of every spring
+uniform samplerBuffer restLengths; // unactuated rest length of every spring
+uniform float strainScale; // strain at which a spring is fully red (stretched) or blue (compressed)
+
+uniform mat4 model;
+
+// shared by every program through the UBO at CAMERA_BLOCK_BINDING
+layout (std140) uniform Camera
+{
+    mat4 view;
+    mat4 proj;
+};
+
+// keep in step with strain_color in RobotMesh.cpp
+const vec3 restColor = vec3(0.83, 0.70, 0.44);
+const vec3 stretchedColor = vec3(0.90, 0.15, 0.10);
+const vec3 compressedColor = vec3(0.15, 0.35, 0.90);
+
+vec3 massPosition(int m)
+{
+    return vec3(texelFetch(positions, 3*m).r, texelFetch(positions, 3*m+1).r, texelFetch(positions, 3*m+2).r);
+}
+
+void main()
+{
+    int spring = gl_VertexID/2;
+    ivec2 ends = texelFetch(springs, spring).rg;
+    vec3 p0 = massPosition(ends.x);
+    vec3 p1 = massPosition(ends.y);
+    
+    float L0 = texelFetch(restLengths, spring).r;
+    float strain = clamp((length(p1-p0) - L0)/(L0*strainScale), -1.0, 1.0);
+    color = strain > 0.0 ? mix(restColor, stretchedColor, strain) : mix(restColor, compressedColor, -strain);
+    
+    gl_Position = proj*view*model*vec4(gl_VertexID%2 == 0 ? p0 : p1, 1.0);
+}
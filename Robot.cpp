@@ -0,0 +1,1594 @@
+//
+//  Robot.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 11/20/21.
+//
+
+#include <stdio.h>
+#include <vector>
+#include <math.h>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdint>
+
+#include "Robot.h"
+#include "Logger.h"
+#include "Profile.h"
+using namespace std;
+
+float T = 0.0;
+float dt = 0.0001;
+bool breathing = false;
+
+vector<int> face0 = {0, 1, 2, 3}; //face 0 (bottom face) corresponds with these cube vertices; only connects with face 5
+vector<int> face1 = {0, 3, 4, 7}; //face 1(front face) corresponds with these cube vertices; only connects with face 3
+vector<int> face2 = {0, 1, 4, 5}; //face 2 (left face) corresponds with these cube vertices; only connects with face 4
+vector<int> face3 = {1, 2, 5, 6}; //face 3 (back face) corrresponds with these cube vertices; only connects with face 1
+vector<int> face4 = {3, 2, 7, 6}; //face 4 (right face) corresponds with these cube vertices; only conncects with face 2
+vector<int> face5 = {4, 5, 6, 7}; //face 5 (top face) corresponds with these cube vertices; only connects with face 0
+
+vector<int> face0_springs = {0, 1, 2, 3, 4, 5}; //face 0 (bottom face) corresponds with these cube springs; only connects with face 5
+vector<int> face1_springs = {3, 6, 9, 10, 11, 21}; //face 1 (front face) corresponds with these cube springs; only connects with face 3
+vector<int> face2_springs = {0, 6, 7, 12, 13, 18}; //face 2 (left face) corresponds with these cube springs; only connects with face 4
+vector<int> face3_springs = {1, 7, 8, 14, 15, 19}; //face 3 (back face) corresponds with these cube springs; only connects with face 1
+vector<int> face4_springs = {2, 9, 8, 17, 16, 20}; //face 4 (right face) corresponds with these cube springs; only connects with face 2
+vector<int> face5_springs = {18, 19, 20, 21, 22, 23}; // face 5 (top face) corresponds with these cube springs; only connects with face 0
+
+void integrate_mass(PointMass &mass){
+    float acc_x = mass.forces[0]/mass.mass;
+    float acc_y = mass.forces[1]/mass.mass;
+    float acc_z = mass.forces[2]/mass.mass;
+
+    mass.acceleration[0] = acc_x;
+    mass.acceleration[1] = acc_y;
+    mass.acceleration[2] = acc_z;
+    
+    float vel_x = acc_x*dt + mass.velocity[0];
+    float vel_y = acc_y*dt + mass.velocity[1];
+    float vel_z = acc_z*dt + mass.velocity[2];
+    
+    
+    mass.velocity[0] = vel_x*b;
+    mass.velocity[1] = vel_y*b;
+    mass.velocity[2] = vel_z*b;
+    
+    float pos_x = (vel_x*dt) + mass.position[0];
+    float pos_y = (vel_y*dt) + mass.position[1];
+    float pos_z = (vel_z*dt) + mass.position[2];
+    
+    mass.position[0] = pos_x;
+    mass.position[1] = pos_y;
+    mass.position[2] = pos_z;
+}
+
+//copies the positions of the robot masses into the cube's own copies of its vertices
+void sync_cube(Robot &robot, int j){
+    int ind0 = robot.all_cubes[j].massIDs[0];
+    int ind1 = robot.all_cubes[j].massIDs[1];
+    int ind2 = robot.all_cubes[j].massIDs[2];
+    int ind3 = robot.all_cubes[j].massIDs[3];
+    int ind4 = robot.all_cubes[j].massIDs[4];
+    int ind5 = robot.all_cubes[j].massIDs[5];
+    int ind6 = robot.all_cubes[j].massIDs[6];
+    int ind7 = robot.all_cubes[j].massIDs[7];
+    
+    for (int k=0; k<8; k++){
+        if (robot.all_cubes[j].masses[k].ID == ind0){
+            robot.all_cubes[j].masses[k].position[0] = robot.masses[ind0].position[0];
+            robot.all_cubes[j].masses[k].position[1] = robot.masses[ind0].position[1];
+            robot.all_cubes[j].masses[k].position[2] = robot.masses[ind0].position[2];
+        }
+        else if (robot.all_cubes[j].masses[k].ID == ind1){
+            robot.all_cubes[j].masses[k].position[0] = robot.masses[ind1].position[0];
+            robot.all_cubes[j].masses[k].position[1] = robot.masses[ind1].position[1];
+            robot.all_cubes[j].masses[k].position[2] = robot.masses[ind1].position[2];
+        }
+        else if (robot.all_cubes[j].masses[k].ID == ind2){
+            robot.all_cubes[j].masses[k].position[0] = robot.masses[ind2].position[0];
+            robot.all_cubes[j].masses[k].position[1] = robot.masses[ind2].position[1];
+            robot.all_cubes[j].masses[k].position[2] = robot.masses[ind2].position[2];
+        }
+        else if (robot.all_cubes[j].masses[k].ID == ind3){
+            robot.all_cubes[j].masses[k].position[0] = robot.masses[ind3].position[0];
+            robot.all_cubes[j].masses[k].position[1] = robot.masses[ind3].position[1];
+            robot.all_cubes[j].masses[k].position[2] = robot.masses[ind3].position[2];
+        }
+        else if (robot.all_cubes[j].masses[k].ID == ind4){
+            robot.all_cubes[j].masses[k].position[0] = robot.masses[ind4].position[0];
+            robot.all_cubes[j].masses[k].position[1] = robot.masses[ind4].position[1];
+            robot.all_cubes[j].masses[k].position[2] = robot.masses[ind4].position[2];
+        }
+        else if (robot.all_cubes[j].masses[k].ID == ind5){
+            robot.all_cubes[j].masses[k].position[0] = robot.masses[ind5].position[0];
+            robot.all_cubes[j].masses[k].position[1] = robot.masses[ind5].position[1];
+            robot.all_cubes[j].masses[k].position[2] = robot.masses[ind5].position[2];
+        }
+        else if (robot.all_cubes[j].masses[k].ID == ind6){
+            robot.all_cubes[j].masses[k].position[0] = robot.masses[ind6].position[0];
+            robot.all_cubes[j].masses[k].position[1] = robot.masses[ind6].position[1];
+            robot.all_cubes[j].masses[k].position[2] = robot.masses[ind6].position[2];
+        }
+        else if (robot.all_cubes[j].masses[k].ID == ind7){
+            robot.all_cubes[j].masses[k].position[0] = robot.masses[ind7].position[0];
+            robot.all_cubes[j].masses[k].position[1] = robot.masses[ind7].position[1];
+            robot.all_cubes[j].masses[k].position[2] = robot.masses[ind7].position[2];
+        }
+    }
+//
+//    robot.all_cubes[j].masses[0].position[0] = robot.masses[ind0].position[0];
+//    robot.all_cubes[j].masses[0].position[1] = robot.masses[ind0].position[1];
+//    robot.all_cubes[j].masses[0].position[2] = robot.masses[ind0].position[2];
+//
+//    robot.all_cubes[j].masses[1].position[0] = robot.masses[ind1].position[0];
+//    robot.all_cubes[j].masses[1].position[1] = robot.masses[ind1].position[1];
+//    robot.all_cubes[j].masses[1].position[2] = robot.masses[ind1].position[2];
+//
+//    robot.all_cubes[j].masses[2].position[0] = robot.masses[ind2].position[0];
+//    robot.all_cubes[j].masses[2].position[1] = robot.masses[ind2].position[1];
+//    robot.all_cubes[j].masses[2].position[2] = robot.masses[ind2].position[2];
+//
+//    robot.all_cubes[j].masses[3].position[0] = robot.masses[ind3].position[0];
+//    robot.all_cubes[j].masses[3].position[1] = robot.masses[ind3].position[1];
+//    robot.all_cubes[j].masses[3].position[2] = robot.masses[ind3].position[2];
+//
+//    robot.all_cubes[j].masses[4].position[0] = robot.masses[ind4].position[0];
+//    robot.all_cubes[j].masses[4].position[1] = robot.masses[ind4].position[1];
+//    robot.all_cubes[j].masses[4].position[2] = robot.masses[ind4].position[2];
+//
+//    robot.all_cubes[j].masses[5].position[0] = robot.masses[ind5].position[0];
+//    robot.all_cubes[j].masses[5].position[1] = robot.masses[ind5].position[1];
+//    robot.all_cubes[j].masses[5].position[2] = robot.masses[ind5].position[2];
+//
+//    robot.all_cubes[j].masses[6].position[0] = robot.masses[ind6].position[0];
+//    robot.all_cubes[j].masses[6].position[1] = robot.masses[ind6].position[1];
+//    robot.all_cubes[j].masses[6].position[2] = robot.masses[ind6].position[2];
+//
+//    robot.all_cubes[j].masses[7].position[0] = robot.masses[ind7].position[0];
+//    robot.all_cubes[j].masses[7].position[1] = robot.masses[ind7].position[1];
+//    robot.all_cubes[j].masses[7].position[2] = robot.masses[ind7].position[2];
+}
+
+void update_pos_vel_acc(Robot &robot){
+    
+    {
+        PROFILE_SCOPE(PHASE_INTEGRATION);
+        for (int i=0; i<robot.masses.size(); i++){
+            integrate_mass(robot.masses[i]);
+        }
+    }
+    
+    {
+        PROFILE_SCOPE(PHASE_CUBE_SYNC);
+        for (int j=0; j<robot.all_cubes.size(); j++){
+            sync_cube(robot, j);
+        }
+    }
+}
+
+void reset_forces(Robot &robot){
+    for(int i=0; i<robot.masses.size(); i++){
+        robot.masses[i].forces = {0.0f, 0.0f, 0.0f};
+    }
+}
+
+//updates spring i's current length and returns the magnitude of its force along the unit vector from m1 to m0
+float spring_force(Robot &robot, int i, float direction[3]){
+    int p0 = robot.springs[i].m0;
+    int p1 = robot.springs[i].m1;
+
+    const vector<float> &pos0 = robot.masses[p0].position;
+    const vector<float> &pos1 = robot.masses[p1].position;
+
+    float spring_length = sqrt(pow(pos1[0]-pos0[0], 2) + pow(pos1[1]-pos0[1], 2) + pow(pos1[2]-pos0[2], 2));
+
+    robot.springs[i].L = spring_length;
+    float force = -robot.springs[i].k*(spring_length-robot.springs[i].L0);
+
+    direction[0] = (pos0[0]-pos1[0])/spring_length;
+    direction[1] = (pos0[1]-pos1[1])/spring_length;
+    direction[2] = (pos0[2]-pos1[2])/spring_length;
+    return force;
+}
+
+//gravity, ground contact and friction on a single mass, once all its spring forces are in
+void apply_external_forces(PointMass &mass){
+    mass.forces[2] = mass.forces[2] + mass.mass*g;
+    
+    if (mass.position[2] < 0){
+        PROFILE_COUNT(EVENT_CONTACTS);
+        mass.forces[2] = -mass.position[2]*1000000.0f;
+    }
+    
+    float F_n = mass.mass*g;
+
+    float F_h = sqrt(pow(mass.forces[0], 2) + pow(mass.forces[1], 2));
+
+
+    if (F_n < 0){
+        if (F_h < -F_n*mu_s){
+            PROFILE_COUNT(EVENT_STATIC_FRICTION);
+            mass.forces[0] = 0;
+            mass.forces[1] = 0;
+        }
+        if (F_h >= -F_n*mu_s){
+            PROFILE_COUNT(EVENT_KINETIC_FRICTION);
+            if (mass.forces[0] > 0){
+                mass.forces[0] = mass.forces[0] + mu_k*F_n;
+            }
+            else{
+                mass.forces[0] = mass.forces[0] - mu_k*F_n;
+            }
+            if (mass.forces[1] > 0){
+                mass.forces[1] = mass.forces[1] + mu_k*F_n;
+            }
+            else{
+                mass.forces[1] = mass.forces[1] - mu_k*F_n;
+            }
+        }
+    }
+}
+
+//adds the kinetic, gravitational and ground contact energy of one mass
+static void mass_energy(const PointMass &mass, double &kinetic, double &gravity, double &contact){
+    const vector<float> &v = mass.velocity;
+    float z = mass.position[2];
+    kinetic += 0.5*mass.mass*(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+    gravity += -mass.mass*g*z;
+    if (z < 0){
+        contact += 0.5*1000000.0*z*z;
+    }
+}
+
+static void store_energy(EnergySample &energy, double kinetic, double elastic, double gravity, double contact){
+    energy.time = T;
+    energy.kinetic = (float)kinetic;
+    energy.elastic = (float)elastic;
+    energy.gravity = (float)gravity;
+    energy.contact = (float)contact;
+}
+
+void update_forces(Robot &robot, EnergySample *energy){
+    double kinetic = 0;
+    double elastic = 0;
+    double gravity = 0;
+    double contact = 0;
+    
+    {
+        PROFILE_SCOPE(PHASE_SPRINGS);
+        for (int i=0; i<robot.springs.size(); i++){
+
+            int p0 = robot.springs[i].m0;
+            int p1 = robot.springs[i].m1;
+
+            float force_unit_dir_2_1[3];
+            float force = spring_force(robot, i, force_unit_dir_2_1);
+
+            for (int n = 0; n < 3; n++) {
+                robot.masses[p0].forces[n] =  robot.masses[p0].forces[n] + force * force_unit_dir_2_1[n];
+                robot.masses[p1].forces[n] =  robot.masses[p1].forces[n] + force * -force_unit_dir_2_1[n];
+            }
+        
+            if (energy != NULL){
+                //spring_force just stored the length, so the elastic energy is three more flops
+                float stretch = robot.springs[i].L - robot.springs[i].L0;
+                elastic += 0.5*robot.springs[i].k*stretch*stretch;
+            }
+        }
+    }
+    
+    {
+        PROFILE_SCOPE(PHASE_EXTERNAL);
+        for (int j=0; j<robot.masses.size(); j++){
+            if (energy != NULL){
+                mass_energy(robot.masses[j], kinetic, gravity, contact);
+            }
+            apply_external_forces(robot.masses[j]);
+        }
+    }
+    
+    if (energy != NULL){
+        store_energy(*energy, kinetic, elastic, gravity, contact);
+    }
+}
+
+//the same sums as update_forces(robot, &energy) without touching the robot, for code that steps some other way
+void measure_energy(const Robot &robot, EnergySample &energy){
+    double kinetic = 0;
+    double elastic = 0;
+    double gravity = 0;
+    double contact = 0;
+    for (int i=0; i<robot.springs.size(); i++){
+        const vector<float> &pos0 = robot.masses[robot.springs[i].m0].position;
+        const vector<float> &pos1 = robot.masses[robot.springs[i].m1].position;
+        float length = sqrt(pow(pos1[0]-pos0[0], 2) + pow(pos1[1]-pos0[1], 2) + pow(pos1[2]-pos0[2], 2));
+        float stretch = length - robot.springs[i].L0;
+        elastic += 0.5*robot.springs[i].k*stretch*stretch;
+    }
+    for (int j=0; j<robot.masses.size(); j++){
+        mass_energy(robot.masses[j], kinetic, gravity, contact);
+    }
+    store_energy(energy, kinetic, elastic, gravity, contact);
+}
+
+void update_breathing(Robot &robot, Controller &control){
+    PROFILE_SCOPE(PHASE_ACTUATION);
+    for (int i=0; i<robot.all_cubes.size(); i++){
+        int ind0 = robot.all_cubes[i].springIDs[0];
+        int ind1 = robot.all_cubes[i].springIDs[1];
+        int ind2 = robot.all_cubes[i].springIDs[2];
+        int ind3 = robot.all_cubes[i].springIDs[3];
+        int ind4 = robot.all_cubes[i].springIDs[4];
+        int ind5 = robot.all_cubes[i].springIDs[5];
+        int ind6 = robot.all_cubes[i].springIDs[6];
+        int ind7 = robot.all_cubes[i].springIDs[7];
+        int ind8 = robot.all_cubes[i].springIDs[8];
+        int ind9 = robot.all_cubes[i].springIDs[9];
+        int ind10 = robot.all_cubes[i].springIDs[10];
+        int ind11 = robot.all_cubes[i].springIDs[11];
+        int ind12 = robot.all_cubes[i].springIDs[12];
+        int ind13 = robot.all_cubes[i].springIDs[13];
+        int ind14 = robot.all_cubes[i].springIDs[14];
+        int ind15 = robot.all_cubes[i].springIDs[15];
+        int ind16 = robot.all_cubes[i].springIDs[16];
+        int ind17 = robot.all_cubes[i].springIDs[17];
+        int ind18 = robot.all_cubes[i].springIDs[18];
+        int ind19 = robot.all_cubes[i].springIDs[19];
+        int ind20 = robot.all_cubes[i].springIDs[20];
+        int ind21 = robot.all_cubes[i].springIDs[21];
+        int ind22 = robot.all_cubes[i].springIDs[22];
+        int ind23 = robot.all_cubes[i].springIDs[23];
+        int ind24 = robot.all_cubes[i].springIDs[24];
+        int ind25 = robot.all_cubes[i].springIDs[25];
+        int ind26 = robot.all_cubes[i].springIDs[26];
+        int ind27 = robot.all_cubes[i].springIDs[27];
+
+        float k = control.motor[i].k;
+        float a = control.motor[i].a;
+        float w = control.motor[i].w;
+        float c = control.motor[i].c;
+
+        robot.springs[ind0].L0 = robot.all_cubes[i].springs[0].original_L0 + a*sin(w*T+c);
+        robot.springs[ind1].L0 = robot.all_cubes[i].springs[1].original_L0 + a*sin(w*T+c);
+        robot.springs[ind2].L0 = robot.all_cubes[i].springs[2].original_L0 + a*sin(w*T+c);
+        robot.springs[ind3].L0 = robot.all_cubes[i].springs[3].original_L0 + a*sin(w*T+c);
+        robot.springs[ind4].L0 = robot.all_cubes[i].springs[4].original_L0 + a*sin(w*T+c);
+        robot.springs[ind5].L0 = robot.all_cubes[i].springs[5].original_L0 + a*sin(w*T+c);
+        robot.springs[ind6].L0 = robot.all_cubes[i].springs[6].original_L0 + a*sin(w*T+c);
+        robot.springs[ind7].L0 = robot.all_cubes[i].springs[7].original_L0 + a*sin(w*T+c);
+        robot.springs[ind8].L0 = robot.all_cubes[i].springs[8].original_L0 + a*sin(w*T+c);
+        robot.springs[ind9].L0 = robot.all_cubes[i].springs[9].original_L0 + a*sin(w*T+c);
+        robot.springs[ind10].L0 = robot.all_cubes[i].springs[10].original_L0 + a*sin(w*T+c);
+        robot.springs[ind11].L0 = robot.all_cubes[i].springs[11].original_L0 + a*sin(w*T+c);
+        robot.springs[ind12].L0 = robot.all_cubes[i].springs[12].original_L0 + a*sin(w*T+c);
+        robot.springs[ind13].L0 = robot.all_cubes[i].springs[13].original_L0 + a*sin(w*T+c);
+        robot.springs[ind14].L0 = robot.all_cubes[i].springs[14].original_L0 + a*sin(w*T+c);
+        robot.springs[ind15].L0 = robot.all_cubes[i].springs[15].original_L0 + a*sin(w*T+c);
+        robot.springs[ind16].L0 = robot.all_cubes[i].springs[16].original_L0 + a*sin(w*T+c);
+        robot.springs[ind17].L0 = robot.all_cubes[i].springs[17].original_L0 + a*sin(w*T+c);
+        robot.springs[ind18].L0 = robot.all_cubes[i].springs[18].original_L0 + a*sin(w*T+c);
+        robot.springs[ind19].L0 = robot.all_cubes[i].springs[19].original_L0 + a*sin(w*T+c);
+        robot.springs[ind20].L0 = robot.all_cubes[i].springs[20].original_L0 + a*sin(w*T+c);
+        robot.springs[ind21].L0 = robot.all_cubes[i].springs[21].original_L0 + a*sin(w*T+c);
+        robot.springs[ind22].L0 = robot.all_cubes[i].springs[22].original_L0 + a*sin(w*T+c);
+        robot.springs[ind23].L0 = robot.all_cubes[i].springs[23].original_L0 + a*sin(w*T+c);
+        robot.springs[ind24].L0 = robot.all_cubes[i].springs[24].original_L0 + a*sin(w*T+c);
+        robot.springs[ind25].L0 = robot.all_cubes[i].springs[25].original_L0 + a*sin(w*T+c);
+        robot.springs[ind26].L0 = robot.all_cubes[i].springs[26].original_L0 + a*sin(w*T+c);
+        robot.springs[ind27].L0 = robot.all_cubes[i].springs[27].original_L0 + a*sin(w*T+c);
+
+        robot.springs[ind0].k = k;
+        robot.springs[ind1].k = k;
+        robot.springs[ind2].k = k;
+        robot.springs[ind3].k = k;
+        robot.springs[ind4].k = k;
+        robot.springs[ind5].k = k;
+        robot.springs[ind6].k = k;
+        robot.springs[ind7].k = k;
+        robot.springs[ind8].k = k;
+        robot.springs[ind9].k = k;
+        robot.springs[ind10].k = k;
+        robot.springs[ind11].k = k;
+        robot.springs[ind12].k = k;
+        robot.springs[ind13].k = k;
+        robot.springs[ind14].k = k;
+        robot.springs[ind15].k = k;
+        robot.springs[ind16].k = k;
+        robot.springs[ind17].k = k;
+        robot.springs[ind18].k = k;
+        robot.springs[ind19].k = k;
+        robot.springs[ind20].k = k;
+        robot.springs[ind21].k = k;
+        robot.springs[ind22].k = k;
+        robot.springs[ind23].k = k;
+        robot.springs[ind24].k = k;
+        robot.springs[ind25].k = k;
+        robot.springs[ind26].k = k;
+        robot.springs[ind27].k = k;
+    }
+}
+
+//cube centers sit on a lattice with 0.5 spacing, so doubling and flooring them gives exact integer cells
+static int64_t lattice_key(const vector<float> &center){
+    int64_t ix = (int64_t)floor(center[0]*2.0f) + (1 << 20);
+    int64_t iy = (int64_t)floor(center[1]*2.0f) + (1 << 20);
+    int64_t iz = (int64_t)floor(center[2]*2.0f) + (1 << 20);
+    return (ix << 42) | (iy << 21) | iz;
+}
+
+static void index_cubes(const vector<Cube> &all_cubes, unordered_map<int64_t, int> &cells){
+    cells.clear();
+    for (int q=0; q<all_cubes.size(); q++){
+        cells[lattice_key(all_cubes[q].center)] = q;
+    }
+}
+
+//returns the cubes in the six cells around center in ascending order, so they get fused in the same order as a scan over all_cubes would
+static vector<int> neighbor_cubes(const unordered_map<int64_t, int> &cells, const vector<float> &center){
+    const float offsets[6][3] = {{0.5f, 0, 0}, {-0.5f, 0, 0}, {0, 0.5f, 0}, {0, -0.5f, 0}, {0, 0, 0.5f}, {0, 0, -0.5f}};
+    vector<int> neighbors;
+    for (int d=0; d<6; d++){
+        vector<float> cell = {center[0]+offsets[d][0], center[1]+offsets[d][1], center[2]+offsets[d][2]};
+        unordered_map<int64_t, int>::const_iterator hit = cells.find(lattice_key(cell));
+        if (hit != cells.end()){
+            neighbors.push_back(hit->second);
+        }
+    }
+    sort(neighbors.begin(), neighbors.end());
+    return neighbors;
+}
+
+//grows the robot one cube at a time; each cube after the first is fused onto a free face of an earlier cube.
+//with rng the placements are drawn at random (and appended to record if given), without it they come from replay
+static bool grow_robot(Robot &robot, int num_cubes, Rng *rng, const Morphology *replay, Morphology *record){
+    vector<PointMass> masses; //initializes the vector of masses that make up the robot
+    vector<Spring> springs; //initializes the vector of springs that make up the robot
+    vector<int> cubes;
+    vector<Cube> all_cubes; //initializes all the cubes that will make up this robot
+    vector<int> available_cubes;
+    unordered_map<int64_t, int> cells; //lattice cell of each cube center -> index in all_cubes
+    
+    masses.reserve(8*num_cubes);
+    springs.reserve(28*num_cubes);
+    all_cubes.reserve(num_cubes);
+    for (int i=0; i<num_cubes; i++){
+        Cube cube; //define a cube
+        initialize_cube(cube); //initialize the cube
+        if (i==0){
+            //for the first cube, you can add everything
+            for (int j=0; j<28; j++){
+                cube.springs[j].ID = j;
+                cube.springIDs.push_back(j);
+                springs.push_back(cube.springs[j]);
+            }
+            for (int k=0; k<8; k++){
+                cube.masses[k].ID = k;
+                cube.massIDs.push_back(k);
+                masses.push_back(cube.masses[k]);
+            }
+            available_cubes.push_back(i);
+            
+        }
+        else{
+            int cube1;
+            int cube1_face1;
+            if (rng != NULL){
+                cube1 = rng->Below((uint32_t)available_cubes.size());
+//                cout << all_cubes[available_cubes[cube1]].free_faces.size() << endl;
+                cube1 = available_cubes[cube1];
+                int face_1 = rng->Below((uint32_t)all_cubes[cube1].free_faces.size());
+                cube1_face1 = all_cubes[cube1].free_faces[face_1];
+//                cube1_face1 = 5;
+                if (record != NULL){
+                    record->parents.push_back(cube1);
+                    record->faces.push_back(cube1_face1);
+                }
+            }
+            else{
+                cube1 = replay->parents[i-1];
+                cube1_face1 = replay->faces[i-1];
+                if (cube1 < 0 || cube1 >= i || find(all_cubes[cube1].free_faces.begin(), all_cubes[cube1].free_faces.end(), cube1_face1) == all_cubes[cube1].free_faces.end()){
+                    LOG_ERROR("Cube " << i << " cannot be placed on face " << cube1_face1 << " of cube " << cube1);
+                    return false;
+                }
+            }
+            int face_2;
+            vector<int> map1;
+            vector<int> map2;
+            vector<int> masses_left;
+            vector<int> springs_left;
+            
+            for (int s=0; s<8; s++){
+                masses_left.push_back(s);
+            }
+            
+            for (int v=0; v<28; v++){
+                springs_left.push_back(v);
+            }
+            
+            if (cube1_face1 == 0){
+                face_2 = 5;
+                
+                map1 = face0;
+                map2 = face5;
+            }
+            else if (cube1_face1 == 5){
+                face_2 = 0;
+                
+                map1 = face5;
+                map2 = face0;
+            }
+            else if (cube1_face1 == 1){
+                face_2 = 3;
+                
+                map1 = face1;
+                map2 = face3;
+            }
+            else if (cube1_face1 == 3){
+                face_2 = 1;
+                
+                map1 = face3;
+                map2 = face1;
+            }
+            else if (cube1_face1 == 2){
+                face_2 = 4;
+                
+                map1 = face2;
+                map2 = face4;
+            }
+            else{
+                face_2 = 2;
+                
+                map1 = face4;
+                map2 = face2;
+            }
+            
+            int itr = find(all_cubes[cube1].free_faces.begin(), all_cubes[cube1].free_faces.end(), cube1_face1)-all_cubes[cube1].free_faces.begin();
+            int itr2 = find(cube.free_faces.begin(), cube.free_faces.end(), face_2)-cube.free_faces.begin();
+            
+            all_cubes[cube1].free_faces.erase(all_cubes[cube1].free_faces.begin()+itr);
+            cube.free_faces.erase(cube.free_faces.begin()+itr2);
+//            remove(all_cubes[cube1].free_faces.begin(), all_cubes[cube1].free_faces.end(), all_cubes[cube1].free_faces[face_1]);
+//            remove(cube.free_faces.begin(), cube.free_faces.end(), cube.free_faces[face_2]);
+            
+            float cube1_z0 = all_cubes[cube1].masses[0].position[2];
+            
+            if (cube1_face1 == 0 && cube1_z0 == 0){
+                LOG_DEBUG("Need to shift the robot up");
+                float x_disp = all_cubes[cube1].masses[map1[0]].position[0]-cube.masses[map2[0]].position[0]; //x displacement
+                float y_disp = all_cubes[cube1].masses[map1[0]].position[1]-cube.masses[map2[0]].position[1]; //y displacement
+                float z_disp = all_cubes[cube1].masses[map1[0]].position[2]-cube.masses[map2[0]].position[2]; //z displacement
+                
+                for (int m=0; m<all_cubes.size(); m++){
+                    for (int n=0; n<8; n++){
+                        //shift cube 2 over
+                        all_cubes[m].masses[n].position[0] -= x_disp;
+                        all_cubes[m].masses[n].position[1] -= y_disp;
+                        all_cubes[m].masses[n].position[2] -= z_disp;
+                        
+                        masses[all_cubes[m].masses[n].ID].position[0] = all_cubes[m].masses[n].position[0];
+                        masses[all_cubes[m].masses[n].ID].position[1] = all_cubes[m].masses[n].position[1];
+                        masses[all_cubes[m].masses[n].ID].position[2] = all_cubes[m].masses[n].position[2];
+                    }
+                    all_cubes[m].center[0] -= x_disp;
+                    all_cubes[m].center[1] -= y_disp;
+                    all_cubes[m].center[2] -= z_disp;
+                }
+                index_cubes(all_cubes, cells);
+            }
+            else{
+                //find where the second cube needs to join the first cube
+                float x_disp = cube.masses[map2[0]].position[0]-all_cubes[cube1].masses[map1[0]].position[0]; //x displacement
+                float y_disp = cube.masses[map2[0]].position[1]-all_cubes[cube1].masses[map1[0]].position[1]; //y displacement
+                float z_disp = cube.masses[map2[0]].position[2]-all_cubes[cube1].masses[map1[0]].position[2]; //z displacement
+                
+                for (int u=0; u<8; u++){
+                    //shift cube 2 over
+                    cube.masses[u].position[0] -= x_disp;
+                    cube.masses[u].position[1] -= y_disp;
+                    cube.masses[u].position[2] -= z_disp;
+                }
+                
+                cube.center[0] -= x_disp;
+                cube.center[1] -= y_disp;
+                cube.center[2] -= z_disp;
+            }
+            LOG_DEBUG("Face 2 = " << face_2);
+            
+            fuse_faces(all_cubes[cube1], cube, cube1, i, masses, springs, cube1_face1, face_2, masses_left, springs_left);
+            
+            vector<int> neighbors = neighbor_cubes(cells, cube.center);
+            for (int n=0; n<neighbors.size(); n++){
+                int q = neighbors[n];
+                if (all_cubes[q].center[0]-cube.center[0] == 0.5 && all_cubes[q].center[1]-cube.center[1] == 0 && all_cubes[q].center[2]-cube.center[2] == 0 && q != cube1){
+                    LOG_DEBUG("Also a cube to the right");
+                    
+                    int itr3 = find(all_cubes[q].free_faces.begin(), all_cubes[q].free_faces.end(), 2)-all_cubes[q].free_faces.begin();
+                    int itr4 = find(cube.free_faces.begin(), cube.free_faces.end(), 4)-cube.free_faces.begin();
+                    
+                    LOG_DEBUG("Here: " << itr3 << ", face " << all_cubes[q].free_faces[itr3]);
+                    
+                    all_cubes[q].free_faces.erase(all_cubes[q].free_faces.begin()+itr3);
+                    cube.free_faces.erase(cube.free_faces.begin()+itr4);
+                    
+                    fuse_faces(all_cubes[q], cube, q, i, masses, springs, 2, 4, masses_left, springs_left);
+                }
+                else if (all_cubes[q].center[0]-cube.center[0] == -0.5 && all_cubes[q].center[1]-cube.center[1] == 0 && all_cubes[q].center[2]-cube.center[2] == 0 && q != cube1){
+                    LOG_DEBUG("Also a cube to the left");
+                    
+                    int itr3 = find(all_cubes[q].free_faces.begin(), all_cubes[q].free_faces.end(), 4)-all_cubes[q].free_faces.begin();
+                    int itr4 = find(cube.free_faces.begin(), cube.free_faces.end(), 2)-cube.free_faces.begin();
+                    
+                    LOG_DEBUG("Here: " << itr3 << ", face " << all_cubes[q].free_faces[itr3]);
+                    
+                    all_cubes[q].free_faces.erase(all_cubes[q].free_faces.begin()+itr3);
+                    cube.free_faces.erase(cube.free_faces.begin()+itr4);
+                    
+                    fuse_faces(all_cubes[q], cube, q, i, masses, springs, 4, 2, masses_left, springs_left);
+                }
+                else if (all_cubes[q].center[1]-cube.center[1] == 0.5 && all_cubes[q].center[0]-cube.center[0] == 0 && all_cubes[q].center[2]-cube.center[2] == 0 && q != cube1){
+                    LOG_DEBUG("Also a cube in front");
+                    
+                    int itr3 = find(all_cubes[q].free_faces.begin(), all_cubes[q].free_faces.end(), 1)-all_cubes[q].free_faces.begin();
+                    int itr4 = find(cube.free_faces.begin(), cube.free_faces.end(), 3)-cube.free_faces.begin();
+                    
+                    LOG_DEBUG("Here: " << itr3 << ", face " << all_cubes[q].free_faces[itr3]);
+                    
+                    all_cubes[q].free_faces.erase(all_cubes[q].free_faces.begin()+itr3);
+                    cube.free_faces.erase(cube.free_faces.begin()+itr4);
+                    
+                    fuse_faces(all_cubes[q], cube, q, i, masses, springs, 1, 3, masses_left, springs_left);
+                }
+                else if (all_cubes[q].center[1]-cube.center[1] == -0.5 && all_cubes[q].center[2]-cube.center[2] == 0 && all_cubes[q].center[0]-cube.center[0] == 0 && q != cube1){
+                    LOG_DEBUG("Also a cube in back");
+                    
+                    int itr3 = find(all_cubes[q].free_faces.begin(), all_cubes[q].free_faces.end(), 3)-all_cubes[q].free_faces.begin();
+                    int itr4 = find(cube.free_faces.begin(), cube.free_faces.end(), 1)-cube.free_faces.begin();
+                    
+                    LOG_DEBUG("Here: " << itr3 << ", face " << all_cubes[q].free_faces[itr3]);
+                    
+                    all_cubes[q].free_faces.erase(all_cubes[q].free_faces.begin()+itr3);
+                    cube.free_faces.erase(cube.free_faces.begin()+itr4);
+                    
+                    fuse_faces(all_cubes[q], cube, q, i, masses, springs, 3, 1, masses_left, springs_left);
+                }
+                else if (all_cubes[q].center[2]-cube.center[2] == 0.5 && all_cubes[q].center[1]-cube.center[1] == 0 && all_cubes[q].center[0]-cube.center[0] == 0 && q != cube1){
+                    LOG_DEBUG("Also a cube on top");
+                    
+                    int itr3 = find(all_cubes[q].free_faces.begin(), all_cubes[q].free_faces.end(), 0)-all_cubes[q].free_faces.begin();
+                    int itr4 = find(cube.free_faces.begin(), cube.free_faces.end(), 5)-cube.free_faces.begin();
+                    
+                    LOG_DEBUG("Here: " << itr3 << ", face " << all_cubes[q].free_faces[itr3]);
+                    
+                    all_cubes[q].free_faces.erase(all_cubes[q].free_faces.begin()+itr3);
+                    cube.free_faces.erase(cube.free_faces.begin()+itr4);
+                    
+                    fuse_faces(all_cubes[q], cube, q, i, masses, springs, 0, 5, masses_left, springs_left);
+                }
+                else if (all_cubes[q].center[2]-cube.center[2] == -0.5 && all_cubes[q].center[1]-cube.center[1] == 0 && all_cubes[q].center[0]-cube.center[0] == 0 && q != cube1){
+                    LOG_DEBUG("Also a cube on bottom");
+                    
+                    int itr3 = find(all_cubes[q].free_faces.begin(), all_cubes[q].free_faces.end(), 5)-all_cubes[q].free_faces.begin();
+                    int itr4 = find(cube.free_faces.begin(), cube.free_faces.end(), 0)-cube.free_faces.begin();
+                    
+                    LOG_DEBUG("Here: " << itr3 << ", face " << all_cubes[q].free_faces[itr3]);
+                    
+                    all_cubes[q].free_faces.erase(all_cubes[q].free_faces.begin()+itr3);
+                    cube.free_faces.erase(cube.free_faces.begin()+itr4);
+                    
+                    fuse_faces(all_cubes[q], cube, q, i, masses, springs, 5, 0, masses_left, springs_left);
+                }
+                
+                //a neighbor that just lost its last free face can no longer be picked (rng.Below(0) otherwise)
+                if (all_cubes[q].free_faces.size() < 1 && q != cube1){
+                    vector<int>::iterator itr6 = find(available_cubes.begin(), available_cubes.end(), q);
+                    if (itr6 != available_cubes.end()){
+                        available_cubes.erase(itr6);
+                    }
+                }
+            }
+            
+            LOG_DEBUG("Masses left = " << masses_left.size());
+            
+            for (int j=0; j<masses_left.size(); j++){
+                // if the vertex is not part of face 2 then you can add it to the big vector of masses and make the ID the index of where it is in the big vector of masses
+                cube.masses[masses_left[j]].ID = masses.size();
+                cube.massIDs.push_back(masses.size());
+                masses.push_back(cube.masses[masses_left[j]]);
+                
+                LOG_TRACE("j = " << j << ", Mass = " << masses_left[j] << ", ID = " << cube.masses[masses_left[j]].ID);
+                
+            }
+            
+            LOG_DEBUG("Springs left = " << springs_left.size());
+            
+            for (int k=0; k<springs_left.size(); k++){
+                int p0 = cube.springs[springs_left[k]].m0;
+                int p1 = cube.springs[springs_left[k]].m1;
+                
+                LOG_TRACE("k = " << k << ", Spring = " << springs_left[k] << ", p0 = " << p0 << ", p1 = " << p1);
+                cube.springs[springs_left[k]].m0 = cube.masses[p0].ID;
+                cube.springs[springs_left[k]].m1 = cube.masses[p1].ID;
+                cube.springs[springs_left[k]].ID = springs.size();
+                cube.springIDs.push_back(springs.size());
+                springs.push_back(cube.springs[springs_left[k]]);
+                
+            }
+            
+            if (cube.free_faces.size() < 1){
+                LOG_DEBUG("Maximized fused faces on this cube");
+            }
+            else{
+                available_cubes.push_back(i);
+            }
+            if (all_cubes[cube1].free_faces.size() < 1){
+                LOG_DEBUG("Maximized fused faces on this cube");
+                int itr5 = find(available_cubes.begin(), available_cubes.end(), cube1)-available_cubes.begin();
+//                remove(available_cubes.begin(), available_cubes.end(), available_cubes[cube1]);
+                available_cubes.erase(available_cubes.begin()+itr5);
+            }
+            
+        }
+        
+        for (int t=0; t<8; t++){
+            LOG_TRACE("MASSES " << t << ", " << cube.masses[t].ID);
+        }
+        
+        cubes.push_back(i);
+        cells[lattice_key(cube.center)] = i;
+        all_cubes.push_back(std::move(cube));
+    }
+    robot.masses = std::move(masses);
+    robot.springs = std::move(springs);
+    robot.cubes = std::move(cubes);
+    robot.all_cubes = std::move(all_cubes);
+    robot.available_cubes = std::move(available_cubes);
+    
+    for (int j=0; j<robot.springs.size(); j++){
+        LOG_TRACE("Spring " << j << ", " << robot.springs[j].m0 << ", " << robot.springs[j].m1);
+    }
+    return true;
+}
+
+void initialize_robot(Robot &robot, int num_cubes, Rng &rng, Morphology *morphology){
+    if (morphology != NULL){
+        morphology->parents.clear();
+        morphology->faces.clear();
+    }
+    grow_robot(robot, num_cubes, &rng, NULL, morphology);
+}
+
+bool build_robot(Robot &robot, const Morphology &morphology){
+    if (morphology.parents.size() != morphology.faces.size()){
+        LOG_ERROR("Morphology has " << morphology.parents.size() << " parents but " << morphology.faces.size() << " faces");
+        return false;
+    }
+    return grow_robot(robot, (int)morphology.parents.size()+1, NULL, &morphology, NULL);
+}
+
+//spreads the low 21 bits of v so there are two zero bits between each of them
+static uint64_t spread_bits(uint64_t v){
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffULL;
+    v = (v | v << 16) & 0x1f0000ff0000ffULL;
+    v = (v | v << 8) & 0x100f00f00f00f00fULL;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+    v = (v | v << 2) & 0x1249249249249249ULL;
+    return v;
+}
+
+//the masses sit on a lattice with 0.5 spacing, so snap them to integer coordinates and interleave them into a Morton code
+static uint64_t morton_code(const vector<float> &position, const float min_corner[3]){
+    uint64_t ix = (uint64_t)lround((position[0]-min_corner[0])/0.5f);
+    uint64_t iy = (uint64_t)lround((position[1]-min_corner[1])/0.5f);
+    uint64_t iz = (uint64_t)lround((position[2]-min_corner[2])/0.5f);
+    return spread_bits(ix) | (spread_bits(iy) << 1) | (spread_bits(iz) << 2);
+}
+
+long count_cache_misses(const Robot &robot){
+    //replays the mass accesses of one update_forces sweep through a small fully associative LRU cache
+    //each line holds the masses that share a 64 byte block of the robot.masses array
+    const int cache_lines = 64;
+    const long masses_per_line = max((long)(64/sizeof(PointMass)), 1L);
+    vector<long> lines;
+    long misses = 0;
+    
+    for (int i=0; i<robot.springs.size(); i++){
+        long touched[2] = {robot.springs[i].m0/masses_per_line, robot.springs[i].m1/masses_per_line};
+        for (int n=0; n<2; n++){
+            vector<long>::iterator hit = find(lines.begin(), lines.end(), touched[n]);
+            if (hit == lines.end()){
+                misses += 1;
+                if (lines.size() == cache_lines){
+                    lines.pop_back();
+                }
+            }
+            else{
+                lines.erase(hit);
+            }
+            lines.insert(lines.begin(), touched[n]);
+        }
+    }
+    return misses;
+}
+
+static double mean_spring_span(const Robot &robot){
+    double span = 0;
+    for (int i=0; i<robot.springs.size(); i++){
+        span += abs(robot.springs[i].m0-robot.springs[i].m1);
+    }
+    return robot.springs.empty() ? 0 : span/robot.springs.size();
+}
+
+LocalityStats reorder_robot(Robot &robot, bool measure){
+    //renumbers the masses along a Morton curve and sorts the springs by their endpoints so that springs
+    //that are next to each other in memory also touch masses that are next to each other in memory
+    LocalityStats stats = {0, 0, 0, 0};
+    if (measure){
+        stats.misses_before = count_cache_misses(robot);
+        stats.span_before = mean_spring_span(robot);
+    }
+    
+    int num_masses = (int)robot.masses.size();
+    int num_springs = (int)robot.springs.size();
+    
+    float min_corner[3] = {0.0f, 0.0f, 0.0f};
+    for (int m=0; m<num_masses; m++){
+        for (int n=0; n<3; n++){
+            if (m == 0 || robot.masses[m].position[n] < min_corner[n]){
+                min_corner[n] = robot.masses[m].position[n];
+            }
+        }
+    }
+    
+    vector<uint64_t> codes(num_masses);
+    vector<int> mass_order(num_masses);
+    for (int m=0; m<num_masses; m++){
+        codes[m] = morton_code(robot.masses[m].position, min_corner);
+        mass_order[m] = m;
+    }
+    stable_sort(mass_order.begin(), mass_order.end(), [&codes](int a, int b){ return codes[a] < codes[b]; });
+    
+    vector<int> new_mass_id(num_masses);
+    vector<PointMass> masses(num_masses);
+    for (int m=0; m<num_masses; m++){
+        new_mass_id[mass_order[m]] = m;
+        masses[m] = robot.masses[mass_order[m]];
+        masses[m].ID = m;
+    }
+    robot.masses = masses;
+    
+    for (int i=0; i<num_springs; i++){
+        robot.springs[i].m0 = new_mass_id[robot.springs[i].m0];
+        robot.springs[i].m1 = new_mass_id[robot.springs[i].m1];
+    }
+    
+    vector<int> spring_order(num_springs);
+    for (int i=0; i<num_springs; i++){
+        spring_order[i] = i;
+    }
+    const vector<Spring> &old_springs = robot.springs;
+    stable_sort(spring_order.begin(), spring_order.end(), [&old_springs](int a, int b){
+        int a_lo = min(old_springs[a].m0, old_springs[a].m1);
+        int b_lo = min(old_springs[b].m0, old_springs[b].m1);
+        if (a_lo != b_lo){
+            return a_lo < b_lo;
+        }
+        return max(old_springs[a].m0, old_springs[a].m1) < max(old_springs[b].m0, old_springs[b].m1);
+    });
+    
+    vector<int> new_spring_id(num_springs);
+    vector<Spring> springs(num_springs);
+    for (int i=0; i<num_springs; i++){
+        new_spring_id[spring_order[i]] = i;
+        springs[i] = robot.springs[spring_order[i]];
+        springs[i].ID = i;
+    }
+    robot.springs = springs;
+    
+    //the cubes keep their own copies of the IDs, so rewrite those too
+    //(IDs that fuse_faces never assigned are left alone)
+    for (int j=0; j<robot.all_cubes.size(); j++){
+        Cube &cube = robot.all_cubes[j];
+        for (int k=0; k<cube.massIDs.size(); k++){
+            cube.massIDs[k] = new_mass_id[cube.massIDs[k]];
+        }
+        for (int k=0; k<cube.springIDs.size(); k++){
+            cube.springIDs[k] = new_spring_id[cube.springIDs[k]];
+        }
+        for (int k=0; k<cube.masses.size(); k++){
+            if (cube.masses[k].ID >= 0 && cube.masses[k].ID < num_masses){
+                cube.masses[k].ID = new_mass_id[cube.masses[k].ID];
+            }
+        }
+        for (int k=0; k<cube.springs.size(); k++){
+            if (cube.springs[k].m0 >= 0 && cube.springs[k].m0 < num_masses){
+                cube.springs[k].m0 = new_mass_id[cube.springs[k].m0];
+            }
+            if (cube.springs[k].m1 >= 0 && cube.springs[k].m1 < num_masses){
+                cube.springs[k].m1 = new_mass_id[cube.springs[k].m1];
+            }
+            if (cube.springs[k].ID >= 0 && cube.springs[k].ID < num_springs){
+                cube.springs[k].ID = new_spring_id[cube.springs[k].ID];
+            }
+        }
+    }
+    
+    if (measure){
+        stats.misses_after = count_cache_misses(robot);
+        stats.span_after = mean_spring_span(robot);
+    }
+    return stats;
+}
+
+//heap footprint of a robot: the vectors it owns plus the small per-mass and per-spring vectors inside them
+size_t robot_memory_bytes(const Robot &robot){
+    size_t bytes = sizeof(Robot);
+    bytes += robot.masses.capacity()*sizeof(PointMass) + robot.springs.capacity()*sizeof(Spring);
+    bytes += robot.cubes.capacity()*sizeof(int) + robot.available_cubes.capacity()*sizeof(int);
+    bytes += robot.all_cubes.capacity()*sizeof(Cube);
+    
+    for (int m=0; m<robot.masses.size(); m++){
+        const PointMass &mass = robot.masses[m];
+        bytes += (mass.position.capacity() + mass.velocity.capacity() + mass.acceleration.capacity() + mass.forces.capacity())*sizeof(float);
+    }
+    for (int j=0; j<robot.all_cubes.size(); j++){
+        const Cube &cube = robot.all_cubes[j];
+        bytes += cube.masses.capacity()*sizeof(PointMass) + cube.springs.capacity()*sizeof(Spring);
+        for (int m=0; m<cube.masses.size(); m++){
+            const PointMass &mass = cube.masses[m];
+            bytes += (mass.position.capacity() + mass.velocity.capacity() + mass.acceleration.capacity() + mass.forces.capacity())*sizeof(float);
+        }
+        bytes += (cube.joinedCubes.capacity() + cube.otherFaces.capacity() + cube.joinedFaces.capacity() + cube.massIDs.capacity() + cube.springIDs.capacity() + cube.free_faces.capacity())*sizeof(int);
+        bytes += cube.center.capacity()*sizeof(float);
+    }
+    return bytes;
+}
+
+void fuse_faces(Cube &cube1, Cube &cube2, int cube1_index, int cube2_index, vector<PointMass> &masses, vector<Spring> &springs, int combine1, int combine2, vector<int> &masses_left, vector<int> &springs_left){
+    
+    vector<int> map1;
+    vector<int> map2;
+    vector<int> map1_springs;
+    vector<int> map2_springs;
+    
+    if (combine1 == 0){
+        map1 = face0;
+        map2 = face5;
+        
+        map1_springs = face0_springs;
+        map2_springs = face5_springs;
+    }
+    else if (combine1 == 5){
+        map1 = face5;
+        map2 = face0;
+        
+        map1_springs = face5_springs;
+        map2_springs = face0_springs;
+    }
+    else if (combine1 == 1){
+        map1 = face1;
+        map2 = face3;
+        
+        map1_springs = face1_springs;
+        map2_springs = face3_springs;
+    }
+    else if (combine1 == 3){
+        map1 = face3;
+        map2 = face1;
+        
+        map1_springs = face3_springs;
+        map2_springs = face1_springs;
+    }
+    else if (combine1 == 2){
+        map1 = face2;
+        map2 = face4;
+        
+        map1_springs = face2_springs;
+        map2_springs = face4_springs;
+    }
+    else{
+        map1 = face4;
+        map2 = face2;
+        
+        map1_springs = face4_springs;
+        map2_springs = face2_springs;
+    }
+    
+    cube1.joinedCubes.push_back(cube2_index);
+    cube1.joinedFaces.push_back(combine1);
+    cube1.otherFaces.push_back(combine2);
+    
+    cube2.joinedCubes.push_back(cube1_index);
+    cube2.joinedFaces.push_back(combine2);
+    cube2.otherFaces.push_back(combine1);
+    
+    //joining cube 2 on the right face of the first cube; this means the left face of cube 2 and the right face of cube 1 will be joined
+    for (int j=0; j<map2.size(); j++){
+        if (find(cube2.massIDs.begin(), cube2.massIDs.end(), cube1.masses[map1[j]].ID) == cube2.massIDs.end()){
+            cube2.masses[map2[j]].ID = cube1.masses[map1[j]].ID; //set the mass ID to its position in the masses vector of the robot
+            cube2.massIDs.push_back(cube1.masses[map1[j]].ID); //add the mass IDs to the list of masses that correspond to cube2
+        }
+        
+        if (find(masses_left.begin(), masses_left.end(), map2[j]) != masses_left.end()){
+//            remove(masses_left.begin(), masses_left.end(), map2[j]);
+            int itr = find(masses_left.begin(), masses_left.end(), map2[j])-masses_left.begin();
+            masses_left.erase(masses_left.begin()+itr);
+        }
+    }
+    
+    for (int k=0; k<map2_springs.size(); k++){
+        //an edge spring can lie on two fused faces; only map it to the robot's masses the first time
+        if (find(springs_left.begin(), springs_left.end(), map2_springs[k]) != springs_left.end()){
+            int p0 = cube2.springs[map2_springs[k]].m0;
+            int p1 = cube2.springs[map2_springs[k]].m1;
+            
+            cube2.springs[map2_springs[k]].m0 = cube2.masses[p0].ID;
+            cube2.springs[map2_springs[k]].m1 = cube2.masses[p1].ID;
+        }
+        
+        if (find(cube2.springIDs.begin(), cube2.springIDs.end(), cube1.springs[map1_springs[k]].ID) == cube2.springIDs.end()){
+            cube2.springs[map2_springs[k]].ID = cube1.springs[map1_springs[k]].ID;
+            cube2.springIDs.push_back(cube1.springs[map1_springs[k]].ID);
+        }
+        
+        
+        if (find(springs_left.begin(), springs_left.end(), map2_springs[k]) != springs_left.end()){
+//            remove(springs_left.begin(), springs_left.end(), map2_springs[k]);
+            int itr = find(springs_left.begin(), springs_left.end(), map2_springs[k])-springs_left.begin();
+            springs_left.erase(springs_left.begin()+itr);
+        }
+    }
+}
+
+void initialize_cube(Cube &cube){
+    vector<PointMass> masses;
+    vector<Spring> springs;
+    
+    initialize_masses(masses);
+    initialize_springs(springs);
+    
+    cube.masses = masses;
+    cube.springs = springs;
+    
+    for (int i=0; i<6; i++){
+        cube.free_faces.push_back(i);
+    }
+    
+    float x_center = 0;
+    float y_center = 0;
+    float z_center = 0;
+    for (int m=0; m<cube.masses.size(); m++){
+        x_center += cube.masses[m].position[0];
+        y_center += cube.masses[m].position[1];
+        z_center += cube.masses[m].position[2];
+    }
+    
+    x_center = x_center/cube.masses.size();
+    y_center = y_center/cube.masses.size();
+    z_center = z_center/cube.masses.size();
+    
+    cube.center = {x_center, y_center, z_center};
+    
+}
+
+void initialize_masses(vector<PointMass> &masses){
+    //Point Mass of bottom, front left vertex
+    //----------------------
+    PointMass mass0;
+    mass0.mass = 1.0f;
+    mass0.position = {-0.25f, -0.25f, 0.0f};
+    mass0.velocity = {0.0f, 0.0f, 0.0f};
+    mass0.acceleration = {0.0f, 0.0f, 0.0f};
+    mass0.forces = {0.0f, 0.0f, 0.0f};
+    //----------------------
+    
+    //Point Mass of bottom, back left vertex
+    //----------------------
+    PointMass mass1;
+    mass1.mass = 1.0f;
+    mass1.position = {-0.25f, 0.25f, 0.0f};
+    mass1.velocity = {0.0f, 0.0f, 0.0f};
+    mass1.acceleration = {0.0f, 0.0f, 0.0f};
+    mass1.forces = {0.0f, 0.0f, 0.0f};
+    //----------------------
+    
+    //Point Mass of bottom, back right vertex
+    //----------------------
+    PointMass mass2;
+    mass2.mass = 1.0f;
+    mass2.position = {0.25f, 0.25f, 0.0f};
+    mass2.velocity = {0.0f, 0.0f, 0.0f};
+    mass2.acceleration = {0.0f, 0.0f, 0.0f};
+    mass2.forces = {0.0f, 0.0f, 0.0f};
+    //----------------------
+    
+    //Point Mass of bottom, front right vertex
+    //----------------------
+    PointMass mass3;
+    mass3.mass = 1.0f;
+    mass3.position = {0.25f, -0.25f, 0.0f};
+    mass3.velocity = {0.0f, 0.0f, 0.0f};
+    mass3.acceleration = {0.0f, 0.0f, 0.0f};
+    mass3.forces = {0.0f, 0.0f, 0.0f};
+    //----------------------
+    
+    //Point Mass of top, front left vertex
+    //----------------------
+    PointMass mass4;
+    mass4.mass = 1.0f;
+    mass4.position = {-0.25f, -0.25f, 0.5f};
+    mass4.velocity = {0.0f, 0.0f, 0.0f};
+    mass4.acceleration = {0.0f, 0.0f, 0.0f};
+    mass4.forces = {0.0f, 0.0f, 0.0f};
+    //----------------------
+    
+    //Point Mass of top, back left vertex
+    //----------------------
+    PointMass mass5;
+    mass5.mass = 1.0f;
+    mass5.position = {-0.25f, 0.25f, 0.5f};
+    mass5.velocity = {0.0f, 0.0f, 0.0f};
+    mass5.acceleration = {0.0f, 0.0f, 0.0f};
+    mass5.forces = {0.0f, 0.0f, 0.0f};
+    //----------------------
+    
+    //Point Mass of top, back right vertex
+    //----------------------
+    PointMass mass6;
+    mass6.mass = 1.0f;
+    mass6.position = {0.25f, 0.25f, 0.5f};
+    mass6.velocity = {0.0f, 0.0f, 0.0f};
+    mass6.acceleration = {0.0f, 0.0f, 0.0f};
+    mass6.forces = {0.0f, 0.0f, 0.0f};
+    //----------------------
+    
+    //Point Mass of top, front right vertex
+    //----------------------
+    PointMass mass7;
+    mass7.mass = 1.0f;
+    mass7.position = {0.25f, -0.25f, 0.5f};
+    mass7.velocity = {0.0f, 0.0f, 0.0f};
+    mass7.acceleration = {0.0f, 0.0f, 0.0f};
+    mass7.forces = {0.0f, 0.0f, 0.0f};
+    //----------------------
+    
+    masses = {mass0, mass1, mass2, mass3, mass4, mass5, mass6, mass7};
+    
+}
+
+void initialize_springs(vector<Spring> &springs){
+    
+    //Bottom Face of the Cube
+    //-----------------------
+    Spring spring0;
+    spring0.L0 = 0.5f;
+    spring0.L = 0.5f;
+    spring0.k = spring_constant;
+    spring0.m0 = 0;
+    spring0.m1 = 1;
+    spring0.original_L0 = 0.5f;
+    
+    Spring spring1;
+    spring1.L0 = 0.5f;
+    spring1.L = 0.5f;
+    spring1.k = spring_constant;
+    spring1.m0 = 1;
+    spring1.m1 = 2;
+    spring1.original_L0 = 0.5f;
+    
+    Spring spring2;
+    spring2.L0 = 0.5f;
+    spring2.L = 0.5f;
+    spring2.k = spring_constant;
+    spring2.m0 = 2;
+    spring2.m1 = 3;
+    spring2.original_L0 = 0.5f;
+    
+    Spring spring3;
+    spring3.L0 = 0.5f;
+    spring3.L = 0.5f;
+    spring3.k = spring_constant;
+    spring3.m0 = 3;
+    spring3.m1 = 0;
+    spring3.original_L0 = 0.5f;
+    //----------------------
+    
+    //Cross Springs of Bottom Face
+    //----------------------
+    Spring spring4;
+    spring4.L0 = 0.5f*sqrt(2.0f);
+    spring4.L = 0.5f*sqrt(2.0f);
+    spring4.k = spring_constant;
+    spring4.m0 = 0;
+    spring4.m1 = 2;
+    spring4.original_L0 = 0.5f*sqrt(2.0f);
+    
+    Spring spring5;
+    spring5.L0 = 0.5f*sqrt(2.0f);
+    spring5.L = 0.5f*sqrt(2.0f);
+    spring5.k = spring_constant;
+    spring5.m0 = 1;
+    spring5.m1 = 3;
+    spring5.original_L0 = 0.5f*sqrt(2.0f);
+    //----------------------
+    
+    //Vertical Supports of Cube
+    //----------------------
+    Spring spring6;
+    spring6.L0 = 0.5f;
+    spring6.L = 0.5f;
+    spring6.k = spring_constant;
+    spring6.m0 = 0;
+    spring6.m1 = 4;
+    spring6.original_L0 = 0.5f;
+    
+    Spring spring7;
+    spring7.L0 = 0.5f;
+    spring7.L = 0.5f;
+    spring7.k = spring_constant;
+    spring7.m0 = 1;
+    spring7.m1 = 5;
+    spring7.original_L0 = 0.5f;
+    
+    Spring spring8;
+    spring8.L0 = 0.5f;
+    spring8.L = 0.5f;
+    spring8.k = spring_constant;
+    spring8.m0 = 2;
+    spring8.m1 = 6;
+    spring8.original_L0 = 0.5f;
+    
+    Spring spring9;
+    spring9.L0 = 0.5f;
+    spring9.L = 0.5f;
+    spring9.k = spring_constant;
+    spring9.m0 = 3;
+    spring9.m1 = 7;
+    spring9.original_L0 = 0.5f;
+    //---------------------
+    
+    //Cross Springs of Front Face
+    //---------------------
+    Spring spring10;
+    spring10.L0 = 0.5f*sqrt(2.0f);
+    spring10.L = 0.5f*sqrt(2.0f);
+    spring10.k = spring_constant;
+    spring10.m0 = 0;
+    spring10.m1 = 7;
+    spring10.original_L0 = 0.5f*sqrt(2.0f);
+    
+    Spring spring11;
+    spring11.L0 = 0.5f*sqrt(2.0f);
+    spring11.L = 0.5f*sqrt(2.0f);
+    spring11.k = spring_constant;
+    spring11.m0 = 3;
+    spring11.m1 = 4;
+    spring11.original_L0 = 0.5f*sqrt(2.0f);
+    //---------------------
+    
+    //Cross Springs of Left Face
+    //---------------------
+    Spring spring12;
+    spring12.L0 = 0.5f*sqrt(2.0f);
+    spring12.L = 0.5f*sqrt(2.0f);
+    spring12.k = spring_constant;
+    spring12.m0 = 0;
+    spring12.m1 = 5;
+    spring12.original_L0 = 0.5f*sqrt(2.0f);
+    
+    Spring spring13;
+    spring13.L0 = 0.5f*sqrt(2.0f);
+    spring13.L = 0.5f*sqrt(2.0f);
+    spring13.k = spring_constant;
+    spring13.m0 = 1;
+    spring13.m1 = 4;
+    spring13.original_L0 = 0.5f*sqrt(2.0f);
+    //---------------------
+    
+    //Cross Springs of Back Face
+    //---------------------
+    Spring spring14;
+    spring14.L0 = 0.5f*sqrt(2.0f);
+    spring14.L = 0.5f*sqrt(2.0f);
+    spring14.k = spring_constant;
+    spring14.m0 = 1;
+    spring14.m1 = 6;
+    spring14.original_L0 = 0.5f*sqrt(2.0f);
+    
+    Spring spring15;
+    spring15.L0 = 0.5f*sqrt(2.0f);
+    spring15.L = 0.5f*sqrt(2.0f);
+    spring15.k = spring_constant;
+    spring15.m0 = 2;
+    spring15.m1 = 5;
+    spring15.original_L0 = 0.5f*sqrt(2.0f);
+    //---------------------
+    
+    //Cross Springs of Right Face
+    //---------------------
+    Spring spring16;
+    spring16.L0 = 0.5f*sqrt(2.0f);
+    spring16.L = 0.5f*sqrt(2.0f);
+    spring16.k = spring_constant;
+    spring16.m0 = 2;
+    spring16.m1 = 7;
+    spring16.original_L0 = 0.5f*sqrt(2.0f);
+    
+    Spring spring17;
+    spring17.L0 = 0.5f*sqrt(2.0f);
+    spring17.L = 0.5f*sqrt(2.0f);
+    spring17.k = spring_constant;
+    spring17.m0 = 3;
+    spring17.m1 = 6;
+    spring17.original_L0 = 0.5f*sqrt(2.0f);
+    //---------------------
+    
+    //Top Face of the Cube
+    //---------------------
+    Spring spring18;
+    spring18.L0 = 0.5f;
+    spring18.L = 0.5f;
+    spring18.k = spring_constant;
+    spring18.m0 = 4;
+    spring18.m1 = 5;
+    spring18.original_L0 = 0.5f;
+    
+    Spring spring19;
+    spring19.L0 = 0.5f;
+    spring19.L = 0.5f;
+    spring19.k = spring_constant;
+    spring19.m0 = 5;
+    spring19.m1 = 6;
+    spring19.original_L0 = 0.5f;
+    
+    Spring spring20;
+    spring20.L0 = 0.5f;
+    spring20.L = 0.5f;
+    spring20.k = spring_constant;
+    spring20.m0 = 6;
+    spring20.m1 = 7;
+    spring20.original_L0 = 0.5f;
+    
+    Spring spring21;
+    spring21.L0 = 0.5f;
+    spring21.L = 0.5f;
+    spring21.k = spring_constant;
+    spring21.m0 = 7;
+    spring21.m1 = 4;
+    spring21.original_L0 = 0.5f;
+    //---------------------
+    
+    //Cross Springs of Top Face
+    //---------------------
+    Spring spring22;
+    spring22.L0 = 0.5f*sqrt(2.0f);
+    spring22.L = 0.5f*sqrt(2.0f);
+    spring22.k = spring_constant;
+    spring22.m0 = 4;
+    spring22.m1 = 6;
+    spring22.original_L0 = 0.5f*sqrt(2.0f);
+    
+    Spring spring23;
+    spring23.L0 = 0.5f*sqrt(2.0f);
+    spring23.L = 0.5f*sqrt(2.0f);
+    spring23.k = spring_constant;
+    spring23.m0 = 5;
+    spring23.m1 = 7;
+    spring23.original_L0 = 0.5f*sqrt(2.0f);
+    //---------------------
+    
+    //Inner Cross Springs
+    //---------------------
+    Spring spring24;
+    spring24.L0 = 0.5f*sqrt(3.0f);
+    spring24.L = 0.5f*sqrt(3.0f);
+    spring24.k = spring_constant;
+    spring24.m0 = 0;
+    spring24.m1 = 6;
+    spring24.original_L0 = 0.5f*sqrt(3.0f);
+    
+    Spring spring25;
+    spring25.L0 = 0.5f*sqrt(3.0f);
+    spring25.L = 0.5f*sqrt(3.0f);
+    spring25.k = spring_constant;
+    spring25.m0 = 2;
+    spring25.m1 = 4;
+    spring25.original_L0 = 0.5f*sqrt(3.0f);
+    
+    Spring spring26;
+    spring26.L0 = 0.5f*sqrt(3.0f);
+    spring26.L = 0.5f*sqrt(3.0f);
+    spring26.k = spring_constant;
+    spring26.m0 = 1;
+    spring26.m1 = 7;
+    spring26.original_L0 = 0.5f*sqrt(3.0f);
+    
+    Spring spring27;
+    spring27.L0 = 0.5f*sqrt(3.0f);
+    spring27.L = 0.5f*sqrt(3.0f);
+    spring27.k = spring_constant;
+    spring27.m0 = 3;
+    spring27.m1 = 5;
+    spring27.original_L0 = 0.5f*sqrt(3.0f);
+    //---------------------
+    
+    springs = {spring0, spring1, spring2, spring3, spring4, spring5, spring6, spring7, spring8, spring9, spring10, spring11, spring12, spring13, spring14, spring15, spring16, spring17, spring18, spring19, spring20, spring21, spring22, spring23, spring24, spring25, spring26, spring27};
+}
+
+void initialize_controller(Controller &control){
+    for (int i=0; i<22; i++){
+        Equation eqn;
+        
+        if (i==0){
+            eqn.k = 1000;
+            eqn.a = 0;
+            eqn.w = 0;
+            eqn.c = 0;
+        }
+        else if (i==1){
+            eqn.k = 1000;
+            eqn.a = 0;
+            eqn.w = 0;
+            eqn.c = 0;
+        }
+        else if (i==2){
+            eqn.k = 1000;
+            eqn.a = 0;
+            eqn.w = 0;
+            eqn.c = 0;
+        }
+        else if (i==3){
+            eqn.k = 5000;
+            eqn.a = 0.15;
+            eqn.w = 2*M_PI;
+            eqn.c = 0;
+        }
+        else if (i==4){
+            eqn.k = 1000;
+            eqn.a = 0;
+            eqn.w = 0;
+            eqn.c = 0;
+        }
+
+        else if (i==5){
+            eqn.k = 10000;
+            eqn.a = 0;
+            eqn.w = 0;
+            eqn.c = 0;
+        }
+        else if (i==6){
+            eqn.k = 5000;
+            eqn.a = 0.1;
+            eqn.w = M_PI;
+            eqn.c = 0;
+        }
+        else if (i==7){
+            eqn.k = 1000;
+            eqn.a = 0;
+            eqn.w = 0;
+            eqn.c = 0;
+        }
+        else if (i==8){
+            eqn.k = 1000;
+            eqn.a = 0;
+            eqn.w = 0;
+            eqn.c = 0;
+        }
+        else if (i==9){
+            eqn.k = 5000;
+            eqn.a = 0.1;
+            eqn.w = M_PI;
+            eqn.c = 0;
+        }
+        else if (i==10){
+            eqn.k = 1000;
+            eqn.a = 0;
+            eqn.w = 0;
+            eqn.c = 0;
+        }
+//        else if (i==11){
+//            eqn.k = 1000;
+//            eqn.a = 0;
+//            eqn.w = 0;
+//            eqn.c = 0;
+//        }
+//        else if (i==12){
+//            eqn.k = 1000;
+//            eqn.a = 0;
+//            eqn.w = 0;
+//            eqn.c = 0;
+//        }
+//        else if (i==13){
+//            eqn.k = 1000;
+//            eqn.a = 0;
+//            eqn.w = 0;
+//            eqn.c = 0;
+//        }
+//        else if (i==14){
+//            eqn.k = 10000;
+//            eqn.a = 0;
+//            eqn.w = 0;
+//            eqn.c = 0;
+//        }
+//        else if (i==15){
+//            eqn.k = 10000;
+//            eqn.a = 0;
+//            eqn.w = 0;
+//            eqn.c = 0;
+//        }
+//        else if (i==16){
+//            eqn.k = 5000;
+//            eqn.a = 0.1;
+//            eqn.w = 3;
+//            eqn.c = M_PI;
+//        }
+//        else if (i==17){
+//            eqn.k = 1000;
+//            eqn.a = 0;
+//            eqn.w = 0;
+//            eqn.c = 0;
+//        }
+//        else if (i==18){
+//            eqn.k = 1000;
+//            eqn.a = 0;
+//            eqn.w = 0;
+//            eqn.c = 0;
+//        }
+//        else if (i==19){
+//            eqn.k = 10000;
+//            eqn.a = 0;
+//            eqn.w = 0;
+//            eqn.c = 0;
+//        }
+//        else if (i==20){
+//            eqn.k = 5000;
+//            eqn.a = 0.1;
+//            eqn.w = 3;
+//            eqn.c = 0;
+//        }
+//        else if (i==21){
+//            eqn.k = 5000;
+//            eqn.a = 0.2;
+//            eqn.w = 3;
+//            eqn.c = 0;
+//        }
+        control.motor.push_back(eqn);
+    }
+}
+
+//draws one actuation equation per cube from the same ranges the hand tuned controller uses
+void randomize_controller(Controller &control, int num_cubes, Rng &rng){
+    control.motor.clear();
+    for (int i=0; i<num_cubes; i++){
+        Equation eqn;
+        eqn.k = rng.Uniform(1000, 10000);
+        eqn.a = rng.Uniform(0, 0.15);
+        eqn.w = rng.Uniform(0, 2*M_PI);
+        eqn.c = rng.Uniform(0, 2*M_PI);
+        control.motor.push_back(eqn);
+    }
+}
+
+//redraws one parameter of each equation with probability rate
+void mutate_controller(Controller &control, float rate, Rng &rng){
+    for (int i=0; i<control.motor.size(); i++){
+        if (rng.Uniform() >= rate){
+            continue;
+        }
+        Equation &eqn = control.motor[i];
+        int parameter = rng.Below(4);
+        if (parameter == 0){
+            eqn.k = rng.Uniform(1000, 10000);
+        }
+        else if (parameter == 1){
+            eqn.a = rng.Uniform(0, 0.15);
+        }
+        else if (parameter == 2){
+            eqn.w = rng.Uniform(0, 2*M_PI);
+        }
+        else{
+            eqn.c = rng.Uniform(0, 2*M_PI);
+        }
+    }
+}
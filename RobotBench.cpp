@@ -0,0 +1,72 @@
+//
+//  RobotBench.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 11/20/21.
+//
+//  Robot generation throughput: builds random morphologies of increasing size with
+//  initialize_robot and reports robots/s, memory per robot and the effect of reorder_robot.
+//  Usage: RobotBench [threads] [population size]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "Robot.h"
+#include "Population.h"
+using namespace std;
+
+static double seconds_since(chrono::steady_clock::time_point start){
+    return chrono::duration<double>(chrono::steady_clock::now()-start).count();
+}
+
+int main(int argc, const char * argv[]) {
+    int num_threads = argc > 1 ? atoi(argv[1]) : (int)thread::hardware_concurrency();
+    int population_size = argc > 2 ? atoi(argv[2]) : 200;
+    num_threads = max(num_threads, 1);
+
+    const int cube_counts[] = {10, 50, 100, 500, 1000, 2000};
+
+    printf("%8s %8s %8s %12s %12s %12s %12s %12s\n", "cubes", "masses", "springs", "robots/s", "pop robots/s", "KB/robot", "misses", "reordered");
+    for (int c=0; c<sizeof(cube_counts)/sizeof(int); c++){
+        int num_cubes = cube_counts[c];
+
+        //keep the total work per row roughly constant
+        int robots = max(population_size*10/num_cubes, 2);
+
+        size_t masses = 0;
+        size_t springs = 0;
+        size_t bytes = 0;
+        //same work per robot as build_population, so the two rates are comparable
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int r=0; r<robots; r++){
+            Robot robot;
+            Rng rng = Rng::Stream(1234, r);
+            initialize_robot(robot, num_cubes, rng);
+            reorder_robot(robot, false);
+            masses += robot.masses.size();
+            springs += robot.springs.size();
+            bytes += robot_memory_bytes(robot);
+        }
+        double serial_rate = robots/seconds_since(start);
+
+        vector<Robot> population;
+        start = chrono::steady_clock::now();
+        build_population(population, robots, num_cubes, 1234, num_threads);
+        double parallel_rate = robots/seconds_since(start);
+
+        //reorder_robot already ran inside build_population, so rebuild one robot to measure the difference
+        Robot sample;
+        Rng sample_rng(99);
+        initialize_robot(sample, num_cubes, sample_rng);
+        LocalityStats locality = reorder_robot(sample);
+
+        printf("%8d %8zu %8zu %12.1f %12.1f %12.1f %12ld %12ld\n", num_cubes, masses/robots, springs/robots, serial_rate, parallel_rate, bytes/robots/1024.0, locality.misses_before, locality.misses_after);
+    }
+    printf("pop robots/s uses %d threads\n", num_threads);
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+//
+//  RobotExport.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/18/21.
+//
+//  Headless frame export: simulates a robot like the viewer does and renders every frame with
+//  SoftwareRenderer, several frames at a time across a ThreadPool, then writes them in order.
+//  Usage: RobotExport <target> [seconds] [fps] [width] [height] [seed] [threads] [trajectory]
+//  The optional trajectory file records one frame per exported frame, for "RobotCreator replay".
+//  e.g.   RobotExport "|ffmpeg -f image2pipe -framerate 30 -i - gait.mp4" 10 30
+//         RobotExport frames/%05d.ppm 5
+//         RobotExport - 10 30 640 480 | ffmpeg -f rawvideo -pix_fmt rgb24 -s 640x480 -r 30 -i - gait.mp4
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Robot.h"
+#include "SoftwareRenderer.h"
+#include "FrameWriter.h"
+#include "ThreadPool.h"
+#include "Trajectory.h"
+#include "Logger.h"
+using namespace std;
+
+static double seconds_since(chrono::steady_clock::time_point start){
+    return chrono::duration<double>(chrono::steady_clock::now()-start).count();
+}
+
+int main(int argc, const char * argv[]) {
+    if (argc < 2){
+        fprintf(stderr, "Usage: RobotExport <target> [seconds] [fps] [width] [height] [seed] [threads] [trajectory]\n");
+        return -1;
+    }
+    string target = argv[1];
+    float seconds = argc > 2 ? atof(argv[2]) : 10.0f;
+    float fps = argc > 3 ? atof(argv[3]) : 30.0f;
+    int width = argc > 4 ? atoi(argv[4]) : 640;
+    int height = argc > 5 ? atoi(argv[5]) : 480;
+    uint64_t seed = argc > 6 ? strtoull(argv[6], NULL, 10) : static_cast<uint64_t>(time(0));
+    int num_threads = argc > 7 ? atoi(argv[7]) : 0;
+    const char* trajectoryFile = argc > 8 ? argv[8] : NULL;
+
+    //the frames own standard output, so keep the log off it
+    if (target == "-"){
+        Logger::Get().SetLevel(LOG_LEVEL_OFF);
+    }
+
+    FrameWriter writer(target);
+    if (!writer.IsOpen()){
+        return -1;
+    }
+
+    Robot robot;
+    Controller control;
+    Rng rng(seed);
+    initialize_robot(robot, 10, rng);
+    reorder_robot(robot, false);
+    initialize_controller(control);
+
+    //the viewer's starting camera and model matrix
+    SoftwareRenderer renderer(robot, width, height);
+    glm::vec3 cameraPos   = glm::vec3(10.0f, 2.0f, 3.0f);
+    glm::vec3 cameraFront = glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::vec3 cameraUp    = glm::vec3(0.0f, 0.0f, 1.0f);
+    float fov = 60.0f;
+    renderer.proj = glm::perspective(glm::radians(fov), (float)width / (float)height, 0.1f, 100.0f);
+    renderer.view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+    renderer.model = glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, 10.0f, 0.0f));
+
+    ThreadPool pool(num_threads);
+    int substeps = max((int)lround(1.0/(fps*dt)), 1);
+    TrajectoryRecorder* recorder = NULL;
+    if (trajectoryFile){
+        recorder = new TrajectoryRecorder(trajectoryFile, robot, substeps, TRAJECTORY_POSITIONS | TRAJECTORY_SPRING_LENGTHS);
+    }
+    long step = 0;
+    long total = lround(seconds*fps);
+    int batch = pool.Size()*4;
+    vector<vector<float> > snapshots(batch, vector<float>(3*robot.masses.size()));
+    vector<Frame> frames(batch);
+    fprintf(stderr, "Seed %llu: %ld frames of %dx%d, %d substeps per frame, %d threads\n", (unsigned long long)seed, total, width, height, substeps, pool.Size());
+
+    double simulate_time = 0;
+    double render_time = 0;
+    double write_time = 0;
+    for (long first=0; first<total; first+=batch){
+        int count = (int)min((long)batch, total-first);
+
+        //the physics is sequential, so take a batch of snapshots first...
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int f=0; f<count; f++){
+            if (first+f > 0){
+                for (int k=0; k<substeps; k++){
+                    T = T + dt;
+                    if (breathing) {
+                        update_breathing(robot, control);
+                    }
+                    update_forces(robot);
+                    update_pos_vel_acc(robot);
+                    reset_forces(robot);
+                }
+                step += substeps;
+            }
+            if (recorder){
+                recorder->Record(robot, step);
+            }
+            for (int m=0; m<robot.masses.size(); m++){
+                snapshots[f][3*m+0] = robot.masses[m].position[0];
+                snapshots[f][3*m+1] = robot.masses[m].position[1];
+                snapshots[f][3*m+2] = robot.masses[m].position[2];
+            }
+        }
+        simulate_time += seconds_since(start);
+
+        //...then rasterize them in parallel...
+        start = chrono::steady_clock::now();
+        pool.ParallelFor(count, [&](int begin, int end, int /*worker*/){
+            for (int f=begin; f<end; f++){
+                renderer.Render(snapshots[f], frames[f]);
+            }
+        });
+        render_time += seconds_since(start);
+
+        //...and write them out in order
+        start = chrono::steady_clock::now();
+        for (int f=0; f<count; f++){
+            if (!writer.Write(frames[f])){
+                return -1;
+            }
+        }
+        write_time += seconds_since(start);
+    }
+    writer.Close();
+    if (recorder){
+        recorder->Close();
+        delete recorder;
+    }
+
+    double elapsed = simulate_time + render_time + write_time;
+    fprintf(stderr, "%ld frames in %.2f s (%.1f frames/s): simulate %.2f s, render %.2f s (%.1f frames/s), write %.2f s\n", writer.frames, elapsed, writer.frames/elapsed, simulate_time, render_time, writer.frames/render_time, write_time);
+
+    return 0;
+}
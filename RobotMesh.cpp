@@ -0,0 +1,46 @@
+//
+//  RobotMesh.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/18/21.
+//
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include "RobotMesh.h"
+using namespace std;
+
+vector<unsigned int> spring_indices(const Robot &robot)
+{
+    vector<unsigned int> indices;
+    indices.reserve(2*robot.springs.size());
+    for (int i=0; i<robot.springs.size(); i++){
+        indices.push_back(robot.springs[i].m0);
+        indices.push_back(robot.springs[i].m1);
+    }
+    return indices;
+}
+
+vector<float> rest_lengths(const Robot &robot)
+{
+    vector<float> lengths(robot.springs.size());
+    for (int i=0; i<robot.springs.size(); i++){
+        lengths[i] = robot.springs[i].original_L0;
+    }
+    return lengths;
+}
+
+void strain_color(float strain, float scale, float color[3])
+{
+    static const float rest[3] = {0.83f, 0.70f, 0.44f};
+    static const float stretched[3] = {0.90f, 0.15f, 0.10f};
+    static const float compressed[3] = {0.15f, 0.35f, 0.90f};
+    
+    float t = min(max(strain/scale, -1.0f), 1.0f);
+    const float* target = t > 0 ? stretched : compressed;
+    t = fabsf(t);
+    for (int c=0; c<3; c++){
+        color[c] = rest[c] + (target[c]-rest[c])*t;
+    }
+}
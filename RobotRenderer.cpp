@@ -0,0 +1,74 @@
+//
+//  RobotRenderer.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/4/21.
+//
+
+#include <stdio.h>
+#include "RobotRenderer.h"
+#include "Profile.h"
+
+//m0, m1 of every spring as the signed ints an isamplerBuffer reads
+static std::vector<GLint> spring_ends(const Robot &robot)
+{
+    std::vector<unsigned int> indices = spring_indices(robot);
+    return std::vector<GLint>(indices.begin(), indices.end());
+}
+
+RobotRenderer::RobotRenderer(const Robot &robot) :
+    springCount((int)robot.springs.size()),
+    positions(NULL, robot.masses.size()*3*sizeof(GLfloat), GL_R32F, GL_DYNAMIC_DRAW),
+    springs(spring_ends(robot).data(), robot.springs.size()*2*sizeof(GLint), GL_RG32I),
+    restLengths(rest_lengths(robot).data(), robot.springs.size()*sizeof(GLfloat), GL_R32F)
+{
+    staging.assign(robot.masses.size()*3, 0.0f);
+    Update(robot);
+}
+
+void RobotRenderer::SetUniforms(const Shader &shader, float strainScale)
+{
+    shader.setInt("positions", 0);
+    shader.setInt("springs", 1);
+    shader.setInt("restLengths", 2);
+    shader.setFloat("strainScale", strainScale);
+}
+
+void RobotRenderer::Update(const Robot &robot)
+{
+    for (int m=0; m<robot.masses.size(); m++){
+        staging[3*m+0] = robot.masses[m].position[0];
+        staging[3*m+1] = robot.masses[m].position[1];
+        staging[3*m+2] = robot.masses[m].position[2];
+    }
+    Update(staging);
+}
+
+void RobotRenderer::Update(const std::vector<float> &positions)
+{
+    Update(positions.data());
+}
+
+void RobotRenderer::Update(const float* positions)
+{
+    PROFILE_SCOPE(PHASE_RENDER_UPLOAD);
+    RobotRenderer::positions.Update(positions, RobotRenderer::positions.capacity);
+}
+
+void RobotRenderer::Draw()
+{
+    positions.Bind(0);
+    springs.Bind(1);
+    restLengths.Bind(2);
+    vao.Bind();
+    glDrawArrays(GL_LINES, 0, 2*springCount);
+    vao.Unbind();
+}
+
+void RobotRenderer::Delete()
+{
+    vao.Delete();
+    positions.Delete();
+    springs.Delete();
+    restLengths.Delete();
+}
@@ -0,0 +1,85 @@
+//
+//  Scheduler.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/12/21.
+//
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include "Scheduler.h"
+
+static const double achieved_window = 0.5; //seconds of wall time per achieved measurement
+
+Scheduler::Scheduler(double step, double budget, double factor)
+{
+    Scheduler::step = step;
+    Scheduler::budget = budget;
+    Scheduler::factor = factor;
+    cost = 0;
+    achieved = 0;
+    anchorTime = 0;
+    anchorSteps = 0;
+    windowTime = 0;
+    windowSteps = 0;
+}
+
+void Scheduler::SetFactor(double factor, double now, long steps)
+{
+    Scheduler::factor = factor;
+    anchorTime = now;
+    anchorSteps = steps;
+    windowTime = now;
+    windowSteps = steps;
+}
+
+int Scheduler::MaxBatch() const
+{
+    //until the first batch has been timed, start small
+    if (cost <= 0){
+        return 16;
+    }
+    return std::max((int)(budget/cost), 1);
+}
+
+int Scheduler::Plan(double now, long steps)
+{
+    int max_batch = MaxBatch();
+    if (factor <= 0){
+        return max_batch;
+    }
+
+    double due = (now-anchorTime)*factor/step - (steps-anchorSteps);
+    if (due < 1){
+        return 0;
+    }
+    if (due > max_batch){
+        //behind schedule: run one full batch and forget the rest rather than trying to catch up
+        anchorTime = now - (steps-anchorSteps+max_batch)*step/factor;
+        return max_batch;
+    }
+    return (int)due;
+}
+
+double Scheduler::Idle(double now, long steps) const
+{
+    if (factor <= 0){
+        return 0;
+    }
+    double next = anchorTime + (steps-anchorSteps+1)*step/factor;
+    return std::min(std::max(next-now, 0.0), budget);
+}
+
+void Scheduler::Record(int substeps, double elapsed, double now, long steps)
+{
+    if (substeps > 0){
+        double sample = elapsed/substeps;
+        cost = cost <= 0 ? sample : 0.9*cost + 0.1*sample;
+    }
+    if (now-windowTime >= achieved_window){
+        achieved = (steps-windowSteps)*step/(now-windowTime);
+        windowTime = now;
+        windowSteps = steps;
+    }
+}
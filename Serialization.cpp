@@ -0,0 +1,213 @@
+//
+//  Serialization.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/2/22.
+//
+
+#include <stdio.h>
+#include <string>
+#include "Serialization.h"
+#include "Logger.h"
+using namespace std;
+
+static void write_mass(BinaryWriter &out, const PointMass &mass){
+    out.Write(mass.mass);
+    out.WriteVector(mass.position);
+    out.WriteVector(mass.velocity);
+    out.WriteVector(mass.acceleration);
+    out.WriteVector(mass.forces);
+    out.Write((int32_t)mass.ID);
+}
+
+static void read_mass(BinaryReader &in, PointMass &mass){
+    int32_t ID = 0;
+    in.Read(mass.mass);
+    in.ReadVector(mass.position);
+    in.ReadVector(mass.velocity);
+    in.ReadVector(mass.acceleration);
+    in.ReadVector(mass.forces);
+    in.Read(ID);
+    mass.ID = ID;
+}
+
+static void write_spring(BinaryWriter &out, const Spring &spring){
+    out.Write(spring.L0);
+    out.Write(spring.L);
+    out.Write(spring.k);
+    out.Write((int32_t)spring.m0);
+    out.Write((int32_t)spring.m1);
+    out.Write(spring.original_L0);
+    out.Write((int32_t)spring.ID);
+}
+
+static void read_spring(BinaryReader &in, Spring &spring){
+    int32_t m0 = 0;
+    int32_t m1 = 0;
+    int32_t ID = 0;
+    in.Read(spring.L0);
+    in.Read(spring.L);
+    in.Read(spring.k);
+    in.Read(m0);
+    in.Read(m1);
+    in.Read(spring.original_L0);
+    in.Read(ID);
+    spring.m0 = m0;
+    spring.m1 = m1;
+    spring.ID = ID;
+}
+
+static void write_masses(BinaryWriter &out, const vector<PointMass> &masses){
+    out.Write((uint32_t)masses.size());
+    for (int m=0; m<masses.size(); m++){
+        write_mass(out, masses[m]);
+    }
+}
+
+static void read_masses(BinaryReader &in, vector<PointMass> &masses){
+    uint32_t count = 0;
+    in.Read(count);
+    //every mass takes at least 4 count words, so a corrupt count cannot ask for more than the file holds
+    if (!in.ok || count > in.Remaining()/16){
+        in.ok = false;
+        return;
+    }
+    masses.resize(count);
+    for (int m=0; m<count && in.ok; m++){
+        read_mass(in, masses[m]);
+    }
+}
+
+static void write_springs(BinaryWriter &out, const vector<Spring> &springs){
+    out.Write((uint32_t)springs.size());
+    for (int i=0; i<springs.size(); i++){
+        write_spring(out, springs[i]);
+    }
+}
+
+static void read_springs(BinaryReader &in, vector<Spring> &springs){
+    uint32_t count = 0;
+    in.Read(count);
+    if (!in.ok || count > in.Remaining()/28){
+        in.ok = false;
+        return;
+    }
+    springs.resize(count);
+    for (int i=0; i<count && in.ok; i++){
+        read_spring(in, springs[i]);
+    }
+}
+
+static void write_ints(BinaryWriter &out, const vector<int> &values){
+    out.WriteVector(vector<int32_t>(values.begin(), values.end()));
+}
+
+static void read_ints(BinaryReader &in, vector<int> &values){
+    vector<int32_t> stored;
+    in.ReadVector(stored);
+    values.assign(stored.begin(), stored.end());
+}
+
+void write_robot(BinaryWriter &out, const Robot &robot){
+    write_masses(out, robot.masses);
+    write_springs(out, robot.springs);
+    write_ints(out, robot.cubes);
+    out.Write((uint32_t)robot.all_cubes.size());
+    for (int j=0; j<robot.all_cubes.size(); j++){
+        const Cube &cube = robot.all_cubes[j];
+        write_masses(out, cube.masses);
+        write_springs(out, cube.springs);
+        write_ints(out, cube.joinedCubes);
+        write_ints(out, cube.otherFaces);
+        write_ints(out, cube.joinedFaces);
+        write_ints(out, cube.massIDs);
+        write_ints(out, cube.springIDs);
+        write_ints(out, cube.free_faces);
+        out.WriteVector(cube.center);
+    }
+    write_ints(out, robot.available_cubes);
+}
+
+void read_robot(BinaryReader &in, Robot &robot){
+    read_masses(in, robot.masses);
+    read_springs(in, robot.springs);
+    read_ints(in, robot.cubes);
+    uint32_t count = 0;
+    in.Read(count);
+    if (!in.ok || count > in.Remaining()/4){
+        in.ok = false;
+        return;
+    }
+    robot.all_cubes.resize(count);
+    for (int j=0; j<count && in.ok; j++){
+        Cube &cube = robot.all_cubes[j];
+        read_masses(in, cube.masses);
+        read_springs(in, cube.springs);
+        read_ints(in, cube.joinedCubes);
+        read_ints(in, cube.otherFaces);
+        read_ints(in, cube.joinedFaces);
+        read_ints(in, cube.massIDs);
+        read_ints(in, cube.springIDs);
+        read_ints(in, cube.free_faces);
+        in.ReadVector(cube.center);
+    }
+    read_ints(in, robot.available_cubes);
+}
+
+void write_controller(BinaryWriter &out, const Controller &control){
+    out.WriteVector(control.motor);
+    out.WriteVector(control.start);
+    out.WriteVector(control.end);
+    out.Write(control.fitness);
+}
+
+void read_controller(BinaryReader &in, Controller &control){
+    in.ReadVector(control.motor);
+    in.ReadVector(control.start);
+    in.ReadVector(control.end);
+    in.Read(control.fitness);
+}
+
+uint64_t fnv1a(const char* data, size_t size){
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i=0; i<size; i++){
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool write_file_atomically(const char* filename, const vector<char> &bytes){
+    string temporary = string(filename) + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (file == NULL){
+        LOG_ERROR("Could not open " << temporary);
+        return false;
+    }
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temporary.c_str(), filename) != 0){
+        LOG_ERROR("Could not write " << filename);
+        remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool read_file(const char* filename, vector<char> &bytes){
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL){
+        LOG_ERROR("Could not open " << filename);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    bytes.resize(size > 0 ? size : 0);
+    bool ok = fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    fclose(file);
+    if (!ok){
+        LOG_ERROR("Could not read " << filename);
+    }
+    return ok;
+}
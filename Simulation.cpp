@@ -0,0 +1,124 @@
+//
+//  Simulation.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/11/21.
+//
+
+#include <stdio.h>
+#include <chrono>
+#include "Simulation.h"
+#include "Scheduler.h"
+using namespace std;
+
+Simulation::Simulation(Robot &robot, Controller &control, double factor, double budget) :
+    robot(robot),
+    control(control)
+{
+    Simulation::budget = budget;
+    target = factor;
+    steps = 0;
+    recorder = NULL;
+    stopping = false;
+
+    //every slot starts out as the initial state, so Latest() is valid before the first Acquire
+    for (int i=0; i<3; i++){
+        snapshots.slots[i].positions.resize(3*robot.masses.size());
+    }
+    for (int i=0; i<3; i++){
+        Publish(0, 0);
+        snapshots.Acquire();
+    }
+}
+
+Simulation::~Simulation()
+{
+    Stop();
+}
+
+void Simulation::Start()
+{
+    if (!worker.joinable()){
+        stopping = false;
+        worker = thread(&Simulation::Run, this);
+    }
+}
+
+void Simulation::Stop()
+{
+    stopping = true;
+    if (worker.joinable()){
+        worker.join();
+    }
+}
+
+void Simulation::Publish(float achieved, float substep_cost)
+{
+    RobotSnapshot &snapshot = snapshots.Back();
+    for (int m=0; m<robot.masses.size(); m++){
+        snapshot.positions[3*m+0] = robot.masses[m].position[0];
+        snapshot.positions[3*m+1] = robot.masses[m].position[1];
+        snapshot.positions[3*m+2] = robot.masses[m].position[2];
+    }
+    snapshot.time = T;
+    snapshot.steps = steps;
+    snapshot.target = target.load(memory_order_relaxed);
+    snapshot.achieved = achieved;
+    snapshot.substep_cost = substep_cost;
+    if (energy.Size() > 0){
+        snapshot.energy = energy.Newest();
+    }
+    else{
+        measure_energy(robot, snapshot.energy);
+        snapshot.energy.step = steps;
+    }
+    snapshots.Publish();
+}
+
+static double seconds_since(chrono::steady_clock::time_point start){
+    return chrono::duration<double>(chrono::steady_clock::now()-start).count();
+}
+
+void Simulation::Run()
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    double factor = target.load(memory_order_relaxed);
+    Scheduler scheduler(dt, budget, factor);
+    scheduler.SetFactor(factor, 0, steps);
+    if (recorder){
+        recorder->Record(robot, steps);
+    }
+
+    while (!stopping.load(memory_order_relaxed)){
+        double now = seconds_since(start);
+        if (target.load(memory_order_relaxed) != scheduler.factor){
+            scheduler.SetFactor(target.load(memory_order_relaxed), now, steps);
+        }
+
+        int substeps = scheduler.Plan(now, steps);
+        if (substeps == 0){
+            this_thread::sleep_for(chrono::duration<double>(scheduler.Idle(now, steps)));
+            continue;
+        }
+
+        for (int k=0; k<substeps; k++){
+            T = T + dt; //update time that has passed
+            if (breathing) {
+                update_breathing(robot, control);
+            }
+
+            update_forces(robot, energy.Sample(steps+k));
+            update_pos_vel_acc(robot);
+
+            reset_forces(robot);
+            if (recorder){
+                recorder->Record(robot, steps+k+1);
+            }
+        }
+        steps += substeps;
+
+        double finished = seconds_since(start);
+        scheduler.Record(substeps, finished-now, finished, steps);
+        Publish(scheduler.achieved, scheduler.cost);
+    }
+}
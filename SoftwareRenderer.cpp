@@ -0,0 +1,144 @@
+//
+//  SoftwareRenderer.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/18/21.
+//
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include "SoftwareRenderer.h"
+#include "RobotMesh.h"
+using namespace std;
+
+//the grid VAO has no color attribute, so GL draws it in the default (0, 0, 0)
+static const float grid_color[3] = {0.0f, 0.0f, 0.0f};
+
+SoftwareRenderer::SoftwareRenderer(const Robot &robot, int width, int height) :
+    indices(spring_indices(robot)),
+    restLengths(rest_lengths(robot))
+{
+    SoftwareRenderer::width = width;
+    SoftwareRenderer::height = height;
+    view = glm::mat4(1.0f);
+    proj = glm::mat4(1.0f);
+    model = glm::mat4(1.0f);
+    background[0] = 0.1f;
+    background[1] = 0.3f;
+    background[2] = 0.4f;
+    strainScale = 0.05f;
+
+    //same lines as GridRenderer(50, 0.5f)
+    int slices = 50;
+    float spacing = 0.5f;
+    float extent = slices*spacing;
+    for (int i=0; i<=slices; i++){
+        float offset = i*spacing;
+        grid.push_back(glm::vec4(offset, 0.0f, 0.0f, 1.0f));
+        grid.push_back(glm::vec4(offset, extent, 0.0f, 1.0f));
+        grid.push_back(glm::vec4(0.0f, offset, 0.0f, 1.0f));
+        grid.push_back(glm::vec4(extent, offset, 0.0f, 1.0f));
+    }
+}
+
+void SoftwareRenderer::Render(const vector<float> &positions, Frame &frame) const
+{
+    frame.width = width;
+    frame.height = height;
+    frame.rgb.resize((size_t)width*height*3);
+    frame.depth.resize((size_t)width*height);
+
+    unsigned char clear[3];
+    for (int c=0; c<3; c++){
+        clear[c] = (unsigned char)(background[c]*255.0f + 0.5f);
+    }
+    for (size_t p=0; p<frame.depth.size(); p++){
+        frame.rgb[3*p+0] = clear[0];
+        frame.rgb[3*p+1] = clear[1];
+        frame.rgb[3*p+2] = clear[2];
+    }
+    fill(frame.depth.begin(), frame.depth.end(), 1.0f);
+
+    glm::mat4 camera = proj*view;
+    for (int i=0; i<grid.size(); i+=2){
+        Line(frame, camera*grid[i], camera*grid[i+1], grid_color, grid_color);
+    }
+
+    //transform every mass once, then draw the springs between them
+    glm::mat4 mvp = camera*model;
+    int num_masses = (int)positions.size()/3;
+    vector<glm::vec4> clip(num_masses);
+    for (int m=0; m<num_masses; m++){
+        clip[m] = mvp*glm::vec4(positions[3*m+0], positions[3*m+1], positions[3*m+2], 1.0f);
+    }
+    for (int i=0; i<indices.size(); i+=2){
+        unsigned int m0 = indices[i];
+        unsigned int m1 = indices[i+1];
+        float dx = positions[3*m1+0]-positions[3*m0+0];
+        float dy = positions[3*m1+1]-positions[3*m0+1];
+        float dz = positions[3*m1+2]-positions[3*m0+2];
+        float L0 = restLengths[i/2];
+        float color[3];
+        strain_color((sqrtf(dx*dx+dy*dy+dz*dz)-L0)/L0, strainScale, color);
+        Line(frame, clip[m0], clip[m1], color, color);
+    }
+}
+
+void SoftwareRenderer::Line(Frame &frame, glm::vec4 a, glm::vec4 b, const float* colorA, const float* colorB) const
+{
+    //clip against -w <= x, y, z <= w (Liang-Barsky in homogeneous coordinates)
+    float t0 = 0.0f;
+    float t1 = 1.0f;
+    for (int plane=0; plane<6; plane++){
+        int axis = plane/2;
+        float sign = plane%2 == 0 ? 1.0f : -1.0f;
+        float da = a.w + sign*a[axis];
+        float db = b.w + sign*b[axis];
+        if (da < 0 && db < 0){
+            return;
+        }
+        if (da < 0){
+            t0 = max(t0, da/(da-db));
+        }
+        else if (db < 0){
+            t1 = min(t1, da/(da-db));
+        }
+    }
+    if (t0 > t1){
+        return;
+    }
+    glm::vec4 p0 = a + (b-a)*t0;
+    glm::vec4 p1 = a + (b-a)*t1;
+
+    //perspective divide and viewport transform (y flipped, since frames are stored top row first)
+    float x0 = (p0.x/p0.w*0.5f + 0.5f)*width;
+    float y0 = (0.5f - p0.y/p0.w*0.5f)*height;
+    float z0 = p0.z/p0.w*0.5f + 0.5f;
+    float x1 = (p1.x/p1.w*0.5f + 0.5f)*width;
+    float y1 = (0.5f - p1.y/p1.w*0.5f)*height;
+    float z1 = p1.z/p1.w*0.5f + 0.5f;
+
+    float c0[3];
+    float c1[3];
+    for (int c=0; c<3; c++){
+        c0[c] = colorA[c] + (colorB[c]-colorA[c])*t0;
+        c1[c] = colorA[c] + (colorB[c]-colorA[c])*t1;
+    }
+
+    //one sample per pixel along the major axis; window-space depth is linear in screen space
+    int steps = max((int)ceilf(max(fabsf(x1-x0), fabsf(y1-y0))), 1);
+    for (int s=0; s<=steps; s++){
+        float t = (float)s/steps;
+        int x = min(max((int)(x0 + (x1-x0)*t), 0), width-1);
+        int y = min(max((int)(y0 + (y1-y0)*t), 0), height-1);
+        float z = z0 + (z1-z0)*t;
+        size_t p = (size_t)y*width + x;
+        if (z < frame.depth[p]){
+            frame.depth[p] = z;
+            for (int c=0; c<3; c++){
+                frame.rgb[3*p+c] = (unsigned char)((c0[c] + (c1[c]-c0[c])*t)*255.0f + 0.5f);
+            }
+        }
+    }
+}
@@ -0,0 +1,176 @@
+//
+//  StepBench.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/7/22.
+//
+//  Microbenchmarks of the simulation hot paths: update_forces, update_pos_vel_acc, reset_forces,
+//  update_breathing, a full substep and initialize_robot, on robots of 1 to 10000 cubes. Every
+//  kernel is run in batches long enough to time reliably; the spread over the batches is reported
+//  next to the mean, per call, per spring and per mass.
+//  Usage: StepBench [table|csv|json] [ms per batch] [batches]
+//  csv and json (one object per line) go to stdout for tracking regressions, e.g.
+//         StepBench csv > bench-$(git rev-parse --short HEAD).csv
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "Robot.h"
+using namespace std;
+
+struct Measurement{
+    const char* name;
+    int cubes;
+    size_t masses;
+    size_t springs;
+    long calls; // calls per batch
+    int batches;
+    double mean; // ns per call
+    double stddev;
+    double best;
+};
+
+static double seconds_since(chrono::steady_clock::time_point start){
+    return chrono::duration<double>(chrono::steady_clock::now()-start).count();
+}
+
+//setup runs before every batch and is not timed; the batch size is doubled until one batch lasts batch_seconds
+static Measurement measure(const char* name, const Robot &robot, int cubes, double batch_seconds, int batches, const function<void()> &setup, const function<void()> &kernel){
+    Measurement result;
+    result.name = name;
+    result.cubes = cubes;
+    result.masses = robot.masses.size();
+    result.springs = robot.springs.size();
+
+    long calls = 1;
+    while (true){
+        setup();
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (long c=0; c<calls; c++){
+            kernel();
+        }
+        if (seconds_since(start) >= batch_seconds || calls >= (1L << 24)){
+            break;
+        }
+        calls *= 2;
+    }
+
+    //slow kernels (building a 10000 cube robot) get fewer batches, but never fewer than three
+    vector<double> samples;
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    for (int b=0; b<batches; b++){
+        if (b >= 3 && seconds_since(begin) > 50*batch_seconds){
+            break;
+        }
+        setup();
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (long c=0; c<calls; c++){
+            kernel();
+        }
+        samples.push_back(seconds_since(start)*1e9/calls);
+    }
+
+    double sum = 0;
+    double best = samples[0];
+    for (int i=0; i<samples.size(); i++){
+        sum += samples[i];
+        best = min(best, samples[i]);
+    }
+    double mean = sum/samples.size();
+    double variance = 0;
+    for (int i=0; i<samples.size(); i++){
+        variance += (samples[i]-mean)*(samples[i]-mean);
+    }
+    variance /= max((int)samples.size()-1, 1);
+
+    result.calls = calls;
+    result.batches = (int)samples.size();
+    result.mean = mean;
+    result.stddev = sqrt(variance);
+    result.best = best;
+    return result;
+}
+
+static void report(const Measurement &m, const char* format){
+    double per_spring = m.springs > 0 ? m.mean/m.springs : 0;
+    double per_mass = m.masses > 0 ? m.mean/m.masses : 0;
+    if (strcmp(format, "csv") == 0){
+        printf("%s,%d,%zu,%zu,%ld,%d,%.1f,%.1f,%.1f,%.3f,%.3f\n", m.name, m.cubes, m.masses, m.springs, m.calls, m.batches, m.mean, m.stddev, m.best, per_spring, per_mass);
+    }
+    else if (strcmp(format, "json") == 0){
+        printf("{\"benchmark\":\"%s\",\"cubes\":%d,\"masses\":%zu,\"springs\":%zu,\"calls\":%ld,\"batches\":%d,\"ns_per_call\":%.1f,\"stddev_ns\":%.1f,\"min_ns\":%.1f,\"ns_per_spring\":%.3f,\"ns_per_mass\":%.3f}\n", m.name, m.cubes, m.masses, m.springs, m.calls, m.batches, m.mean, m.stddev, m.best, per_spring, per_mass);
+    }
+    else{
+        printf("%-18s %6d %7zu %8zu %14.1f %7.1f%% %12.3f %12.3f\n", m.name, m.cubes, m.masses, m.springs, m.mean, 100*m.stddev/m.mean, per_spring, per_mass);
+    }
+    fflush(stdout);
+}
+
+int main(int argc, const char * argv[]) {
+    const char* format = argc > 1 ? argv[1] : "table";
+    double batch_seconds = (argc > 2 ? atof(argv[2]) : 20)/1000.0;
+    int batches = argc > 3 ? atoi(argv[3]) : 15;
+    const int cube_counts[] = {1, 10, 100, 1000, 10000};
+
+    if (strcmp(format, "csv") == 0){
+        printf("benchmark,cubes,masses,springs,calls,batches,ns_per_call,stddev_ns,min_ns,ns_per_spring,ns_per_mass\n");
+    }
+    else if (strcmp(format, "table") == 0){
+        printf("%-18s %6s %7s %8s %14s %8s %12s %12s\n", "benchmark", "cubes", "masses", "springs", "ns/call", "stddev", "ns/spring", "ns/mass");
+    }
+
+    for (int c=0; c<sizeof(cube_counts)/sizeof(int); c++){
+        int num_cubes = cube_counts[c];
+        Rng rng(2022);
+        Robot initial;
+        Controller control;
+        initialize_robot(initial, num_cubes, rng);
+        reorder_robot(initial, false);
+        randomize_controller(control, num_cubes, rng);
+
+        //let it move a little first (about 10^7 spring updates, up to a simulated second) so springs
+        //are stretched and masses touch the ground, as they do in a real run
+        breathing = true;
+        T = 0;
+        int settle_steps = max(100, min(10000, 10000000/(int)initial.springs.size()));
+        for (int s=0; s<settle_steps; s++){
+            T = T + dt;
+            update_breathing(initial, control);
+            update_forces(initial);
+            update_pos_vel_acc(initial);
+            reset_forces(initial);
+        }
+        float settled = T;
+
+        //each batch starts from the same state, so batches differ only by noise
+        Robot robot = initial;
+        function<void()> restore = [&](){ robot = initial; T = settled; };
+        function<void()> nothing = [](){};
+
+        report(measure("update_forces", robot, num_cubes, batch_seconds, batches, restore, [&](){ update_forces(robot); }), format);
+        report(measure("update_pos_vel_acc", robot, num_cubes, batch_seconds, batches, restore, [&](){ update_pos_vel_acc(robot); }), format);
+        report(measure("reset_forces", robot, num_cubes, batch_seconds, batches, restore, [&](){ reset_forces(robot); }), format);
+        report(measure("update_breathing", robot, num_cubes, batch_seconds, batches, restore, [&](){ T = T + dt; update_breathing(robot, control); }), format);
+        report(measure("step", robot, num_cubes, batch_seconds, batches, restore, [&](){
+            T = T + dt;
+            update_breathing(robot, control);
+            update_forces(robot);
+            update_pos_vel_acc(robot);
+            reset_forces(robot);
+        }), format);
+
+        Robot built;
+        report(measure("initialize_robot", initial, num_cubes, batch_seconds, batches, nothing, [&](){
+            Rng build_rng(2022);
+            initialize_robot(built, num_cubes, build_rng);
+        }), format);
+    }
+
+    return 0;
+}
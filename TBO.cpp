@@ -0,0 +1,52 @@
+//
+//  TBO.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/19/21.
+//
+
+#include <stdio.h>
+#include "TBO.h"
+
+TBO::TBO(const void* data, GLsizeiptr size, GLenum format, GLenum usage)
+{
+    capacity = size;
+    TBO::usage = usage;
+    glGenBuffers(1, &ID);
+    glBindBuffer(GL_TEXTURE_BUFFER, ID);
+    glBufferData(GL_TEXTURE_BUFFER, size, data, usage);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, ID);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void TBO::Update(const void* data, GLsizeiptr size, GLintptr offset)
+{
+    glBindBuffer(GL_TEXTURE_BUFFER, ID);
+    if (offset == 0 && size == capacity){
+        glBufferData(GL_TEXTURE_BUFFER, capacity, NULL, usage);
+    }
+    glBufferSubData(GL_TEXTURE_BUFFER, offset, size, data);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void TBO::Bind(GLuint unit)
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+}
+
+void TBO::Unbind(GLuint unit)
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void TBO::Delete()
+{
+    glDeleteTextures(1, &texture);
+    glDeleteBuffers(1, &ID);
+}
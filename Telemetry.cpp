@@ -0,0 +1,181 @@
+//
+//  Telemetry.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/4/22.
+//
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include "Telemetry.h"
+#include "Logger.h"
+using namespace std;
+
+static const char* kind_names[] = {"evaluation", "generation"};
+
+Telemetry::Telemetry(const char* filename, TelemetryFormat format, int capacity) : emitted(0), dropped(0), written(0)
+{
+    Telemetry::format = format;
+    ring.resize(max(capacity, 1));
+    head = 0;
+    count = 0;
+    stopping = false;
+    file = fopen(filename, "w");
+    if (file == NULL){
+        LOG_ERROR("Could not open telemetry file " << filename);
+        return;
+    }
+    if (format == TELEMETRY_CSV){
+        fprintf(file, "kind,generation,index,fitness,mean_fitness,displacement,steps,wall_time,cubes,masses,springs\n");
+    }
+    writer = thread(&Telemetry::Run, this);
+}
+
+Telemetry::~Telemetry()
+{
+    Close();
+}
+
+bool Telemetry::Emit(const TelemetryRecord &record)
+{
+    if (file == NULL){
+        return false;
+    }
+    emitted++;
+    bool wakeWriter;
+    {
+        lock_guard<mutex> guard(lock);
+        if (count == ring.size()){
+            dropped++;
+            return false;
+        }
+        ring[(head + count) % ring.size()] = record;
+        count++;
+        //the writer wakes on its own every quarter second; only hurry it when the ring fills up
+        wakeWriter = count == ring.size()/2;
+    }
+    if (wakeWriter){
+        wake.notify_one();
+    }
+    return true;
+}
+
+void Telemetry::Close()
+{
+    if (!writer.joinable()){
+        return;
+    }
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+    fclose(file);
+    file = NULL;
+    if (dropped > 0){
+        LOG_WARN("Telemetry dropped " << dropped << " of " << emitted << " records");
+    }
+}
+
+void Telemetry::Run()
+{
+    vector<TelemetryRecord> batch;
+    batch.reserve(ring.size());
+    unique_lock<mutex> guard(lock);
+    while (true){
+        wake.wait_for(guard, chrono::milliseconds(250), [this]{ return stopping || count >= ring.size()/2; });
+
+        //copy the records out so producers only ever wait for a memcpy, never for the file
+        batch.clear();
+        for (size_t i=0; i<count; i++){
+            batch.push_back(ring[(head + i) % ring.size()]);
+        }
+        head = (head + count) % ring.size();
+        count = 0;
+        bool done = stopping;
+        guard.unlock();
+
+        for (int i=0; i<batch.size(); i++){
+            WriteRecord(batch[i]);
+        }
+        if (!batch.empty()){
+            fflush(file);
+            written += batch.size();
+        }
+
+        guard.lock();
+        if (done && count == 0){
+            break;
+        }
+    }
+}
+
+//JSON has no NaN or infinity, so an exploded robot's values are written as null
+static const char* json_number(char* buffer, size_t size, double value, const char* format){
+    if (!isfinite(value)){
+        return "null";
+    }
+    snprintf(buffer, size, format, value);
+    return buffer;
+}
+
+void Telemetry::WriteRecord(const TelemetryRecord &record)
+{
+    const char* kind = kind_names[record.kind];
+    if (format == TELEMETRY_CSV){
+        fprintf(file, "%s,%ld,%ld,%.9g,%.9g,%.9g,%ld,%.6f,%d,%d,%d\n", kind, record.generation, record.index, record.fitness, record.mean_fitness, record.displacement, record.steps, record.wall_time, record.cubes, record.masses, record.springs);
+    }
+    else{
+        char fitness[32], mean_fitness[32], displacement[32], wall_time[32];
+        fprintf(file, "{\"kind\":\"%s\",\"generation\":%ld,\"index\":%ld,\"fitness\":%s,\"mean_fitness\":%s,\"displacement\":%s,\"steps\":%ld,\"wall_time\":%s,\"cubes\":%d,\"masses\":%d,\"springs\":%d}\n", kind, record.generation, record.index,
+                json_number(fitness, sizeof(fitness), record.fitness, "%.9g"), json_number(mean_fitness, sizeof(mean_fitness), record.mean_fitness, "%.9g"),
+                json_number(displacement, sizeof(displacement), record.displacement, "%.9g"), record.steps, json_number(wall_time, sizeof(wall_time), record.wall_time, "%.6f"),
+                record.cubes, record.masses, record.springs);
+    }
+}
+
+TelemetryRecord Telemetry::Evaluation(long generation, long index, const Robot &robot, const Controller &control, long steps, double wall_time)
+{
+    TelemetryRecord record;
+    record.kind = TELEMETRY_EVALUATION;
+    record.generation = generation;
+    record.index = index;
+    record.fitness = control.fitness;
+    record.mean_fitness = 0;
+    record.displacement = 0;
+    if (control.start.size() >= 2 && control.end.size() >= 2){
+        record.displacement = sqrt(pow(control.end[0]-control.start[0], 2) + pow(control.end[1]-control.start[1], 2));
+    }
+    record.steps = steps;
+    record.wall_time = wall_time;
+    record.cubes = (int)robot.all_cubes.size();
+    record.masses = (int)robot.masses.size();
+    record.springs = (int)robot.springs.size();
+    return record;
+}
+
+TelemetryRecord Telemetry::Generation(long generation, const vector<float> &fitness, long steps, double wall_time)
+{
+    TelemetryRecord record;
+    record.kind = TELEMETRY_GENERATION;
+    record.generation = generation;
+    record.index = -1;
+    record.fitness = 0;
+    record.mean_fitness = 0;
+    for (int r=0; r<fitness.size(); r++){
+        record.fitness = r == 0 ? fitness[r] : max(record.fitness, fitness[r]);
+        record.mean_fitness += fitness[r];
+    }
+    if (!fitness.empty()){
+        record.mean_fitness /= fitness.size();
+    }
+    record.displacement = 0;
+    record.steps = steps;
+    record.wall_time = wall_time;
+    record.cubes = 0;
+    record.masses = 0;
+    record.springs = 0;
+    return record;
+}
@@ -0,0 +1,89 @@
+//
+//  ThreadPool.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 11/27/21.
+//
+
+#include <stdio.h>
+#include <algorithm>
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int num_threads)
+{
+    job = NULL;
+    jobSize = 0;
+    generation = 0;
+    pending = 0;
+    stopping = false;
+    if (num_threads <= 0){
+        num_threads = std::max((int)std::thread::hardware_concurrency(), 1);
+    }
+    numThreads = num_threads;
+    for (int w=1; w<num_threads; w++){
+        workers.push_back(std::thread(&ThreadPool::Run, this, w));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    start.notify_all();
+    for (int w=0; w<workers.size(); w++){
+        workers[w].join();
+    }
+}
+
+void ThreadPool::ParallelFor(int n, const Body &body)
+{
+    int size = Size();
+    if (size == 1){
+        body(0, n, 0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        job = &body;
+        jobSize = n;
+        pending = size-1;
+        generation += 1;
+    }
+    start.notify_all();
+
+    body(0, (int)((long)n/size), 0);
+
+    std::unique_lock<std::mutex> guard(lock);
+    done.wait(guard, [this]{ return pending == 0; });
+    job = NULL;
+}
+
+void ThreadPool::Run(int worker)
+{
+    int seen = 0;
+    int size = Size();
+    while (true){
+        const Body* body;
+        int n;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            start.wait(guard, [this, seen]{ return stopping || generation != seen; });
+            if (stopping){
+                return;
+            }
+            seen = generation;
+            body = job;
+            n = jobSize;
+        }
+
+        (*body)((int)((long)n*worker/size), (int)((long)n*(worker+1)/size), worker);
+
+        std::lock_guard<std::mutex> guard(lock);
+        pending -= 1;
+        if (pending == 0){
+            done.notify_one();
+        }
+    }
+}
@@ -0,0 +1,347 @@
+//
+//  Trajectory.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/26/21.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Trajectory.h"
+#include "Logger.h"
+using namespace std;
+
+static const char trajectory_magic[8] = {'P', 'S', 'T', 'R', 'A', 'J', 0, 0};
+static const uint32_t trajectory_version = 1;
+
+static uint64_t align_up(uint64_t bytes, uint64_t alignment)
+{
+    return (bytes + alignment-1)/alignment*alignment;
+}
+
+TrajectoryLayout trajectory_layout(uint32_t columns, uint32_t massCount, uint32_t springCount, uint32_t framesPerChunk, uint32_t pageSize)
+{
+    TrajectoryLayout layout;
+    uint64_t offset = 0;
+    layout.time = offset;
+    offset += (uint64_t)framesPerChunk*sizeof(float);
+    layout.positions = offset;
+    if (columns & TRAJECTORY_POSITIONS){
+        offset += (uint64_t)framesPerChunk*massCount*3*sizeof(float);
+    }
+    layout.velocities = offset;
+    if (columns & TRAJECTORY_VELOCITIES){
+        offset += (uint64_t)framesPerChunk*massCount*3*sizeof(float);
+    }
+    layout.springLengths = offset;
+    if (columns & TRAJECTORY_SPRING_LENGTHS){
+        offset += (uint64_t)framesPerChunk*springCount*sizeof(float);
+    }
+    layout.chunkBytes = align_up(offset, pageSize);
+    return layout;
+}
+
+TrajectoryRecorder::TrajectoryRecorder(const char* filename, const Robot &robot, int stride, uint32_t columns, int framesPerChunk)
+{
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, trajectory_magic, sizeof(header.magic));
+    header.version = trajectory_version;
+    header.columns = columns;
+    header.massCount = (uint32_t)robot.masses.size();
+    header.springCount = (uint32_t)robot.springs.size();
+    header.stride = (uint32_t)max(stride, 1);
+    header.framesPerChunk = (uint32_t)max(framesPerChunk, 1);
+    header.dt = dt;
+    header.pageSize = 4096;
+    header.topologyOffset = header.pageSize;
+    header.chunkOffset = header.topologyOffset + align_up((uint64_t)header.springCount*3*sizeof(int32_t), header.pageSize);
+    layout = trajectory_layout(columns, header.massCount, header.springCount, header.framesPerChunk, header.pageSize);
+    header.chunkBytes = layout.chunkBytes;
+
+    current = NULL;
+    framesInChunk = 0;
+    stopping = false;
+
+    file = fopen(filename, "wb");
+    if (file == NULL){
+        LOG_ERROR("Could not open " << filename << " for the trajectory");
+        return;
+    }
+
+    //header and topology go out right away; the header is rewritten as chunks arrive
+    vector<char> start(header.chunkOffset, 0);
+    memcpy(&start[0], &header, sizeof(header));
+    for (int i=0; i<robot.springs.size(); i++){
+        int32_t entry[3];
+        entry[0] = robot.springs[i].m0;
+        entry[1] = robot.springs[i].m1;
+        memcpy(&entry[2], &robot.springs[i].original_L0, sizeof(float));
+        memcpy(&start[header.topologyOffset + i*sizeof(entry)], entry, sizeof(entry));
+    }
+    fwrite(start.data(), 1, start.size(), file);
+
+    current = new vector<char>(layout.chunkBytes, 0);
+    writer = thread(&TrajectoryRecorder::Run, this);
+}
+
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+    Close();
+}
+
+void TrajectoryRecorder::Record(const Robot &robot, long step)
+{
+    if (file == NULL || step % header.stride != 0){
+        return;
+    }
+
+    char* chunk = current->data();
+    uint32_t f = framesInChunk;
+    memcpy(chunk + layout.time + f*sizeof(float), &T, sizeof(float));
+    if (header.columns & TRAJECTORY_POSITIONS){
+        float* out = (float*)(chunk + layout.positions) + (size_t)f*header.massCount*3;
+        for (int m=0; m<header.massCount; m++){
+            out[3*m+0] = robot.masses[m].position[0];
+            out[3*m+1] = robot.masses[m].position[1];
+            out[3*m+2] = robot.masses[m].position[2];
+        }
+    }
+    if (header.columns & TRAJECTORY_VELOCITIES){
+        float* out = (float*)(chunk + layout.velocities) + (size_t)f*header.massCount*3;
+        for (int m=0; m<header.massCount; m++){
+            out[3*m+0] = robot.masses[m].velocity[0];
+            out[3*m+1] = robot.masses[m].velocity[1];
+            out[3*m+2] = robot.masses[m].velocity[2];
+        }
+    }
+    if (header.columns & TRAJECTORY_SPRING_LENGTHS){
+        float* out = (float*)(chunk + layout.springLengths) + (size_t)f*header.springCount;
+        for (int i=0; i<header.springCount; i++){
+            out[i] = robot.springs[i].L;
+        }
+    }
+
+    framesInChunk += 1;
+    if (framesInChunk == header.framesPerChunk){
+        Submit();
+    }
+}
+
+//hands the current chunk to the writer and starts a new one
+void TrajectoryRecorder::Submit()
+{
+    vector<char>* next = NULL;
+    {
+        lock_guard<mutex> guard(lock);
+        pending.push_back(make_pair(current, framesInChunk));
+        if (!spare.empty()){
+            next = spare.back();
+            spare.pop_back();
+        }
+    }
+    wake.notify_one();
+
+    if (next == NULL){
+        next = new vector<char>(layout.chunkBytes, 0);
+    }
+    current = next;
+    framesInChunk = 0;
+}
+
+void TrajectoryRecorder::Run()
+{
+    uint64_t written = 0;
+    unique_lock<mutex> guard(lock);
+    while (true){
+        wake.wait(guard, [this]{ return stopping || !pending.empty(); });
+        if (pending.empty()){
+            break;
+        }
+        vector<char>* chunk = pending.front().first;
+        written += pending.front().second;
+        pending.pop_front();
+        guard.unlock();
+
+        //chunks land in order, since only this thread writes them
+        fseek(file, 0, SEEK_END);
+        fwrite(chunk->data(), 1, chunk->size(), file);
+        header.frameCount = written;
+        fseek(file, 0, SEEK_SET);
+        fwrite(&header, sizeof(header), 1, file);
+
+        guard.lock();
+        spare.push_back(chunk);
+    }
+}
+
+void TrajectoryRecorder::Close()
+{
+    if (file == NULL){
+        return;
+    }
+    if (framesInChunk > 0){
+        //zero the unused tail so the padding does not carry frames from a reused chunk
+        uint32_t f = framesInChunk;
+        char* chunk = current->data();
+        uint64_t frameBytes[3] = {header.massCount*3*sizeof(float), header.massCount*3*sizeof(float), header.springCount*sizeof(float)};
+        uint64_t columnStart[3] = {layout.positions, layout.velocities, layout.springLengths};
+        uint32_t flags[3] = {TRAJECTORY_POSITIONS, TRAJECTORY_VELOCITIES, TRAJECTORY_SPRING_LENGTHS};
+        memset(chunk + layout.time + f*sizeof(float), 0, (header.framesPerChunk-f)*sizeof(float));
+        for (int c=0; c<3; c++){
+            if (header.columns & flags[c]){
+                memset(chunk + columnStart[c] + f*frameBytes[c], 0, (header.framesPerChunk-f)*frameBytes[c]);
+            }
+        }
+        Submit();
+    }
+    else{
+        delete current;
+    }
+    current = NULL;
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+
+    for (int i=0; i<spare.size(); i++){
+        delete spare[i];
+    }
+    spare.clear();
+    fclose(file);
+    file = NULL;
+}
+
+TrajectoryReader::TrajectoryReader(const char* filename)
+{
+    data = NULL;
+    size = 0;
+    topology = NULL;
+    memset(&header, 0, sizeof(header));
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0){
+        LOG_ERROR("Could not open trajectory " << filename);
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(header)){
+        LOG_ERROR(filename << " is not a trajectory");
+        close(fd);
+        return;
+    }
+    void* mapped = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED){
+        LOG_ERROR("Could not map trajectory " << filename);
+        return;
+    }
+
+    memcpy(&header, mapped, sizeof(header));
+    if (memcmp(header.magic, trajectory_magic, sizeof(trajectory_magic)) != 0 || header.version != trajectory_version){
+        LOG_ERROR(filename << " is not a version " << trajectory_version << " trajectory");
+        munmap(mapped, info.st_size);
+        return;
+    }
+    //the header has to describe a layout this reader would have written, with the topology on disk
+    uint64_t fileSize = (uint64_t)info.st_size;
+    uint64_t topologyEnd = header.topologyOffset + (uint64_t)header.springCount*3*sizeof(int32_t);
+    bool consistent = header.pageSize > 0 && header.framesPerChunk > 0 && header.stride > 0;
+    if (consistent){
+        layout = trajectory_layout(header.columns, header.massCount, header.springCount, header.framesPerChunk, header.pageSize);
+        consistent = header.chunkBytes == layout.chunkBytes && header.chunkBytes > 0
+            && header.topologyOffset >= sizeof(header) && topologyEnd <= header.chunkOffset && topologyEnd <= fileSize;
+    }
+    if (!consistent){
+        LOG_ERROR(filename << " is truncated or has an inconsistent trajectory header");
+        munmap(mapped, info.st_size);
+        return;
+    }
+
+    //a recording that is still running (or crashed) may have fewer complete chunks on disk than the header
+    //counts frames for, down to none at all
+    uint64_t chunks = fileSize > header.chunkOffset ? (fileSize - header.chunkOffset)/header.chunkBytes : 0;
+    header.frameCount = min(header.frameCount, chunks*header.framesPerChunk);
+
+    data = (const char*)mapped;
+    size = info.st_size;
+    topology = (const int32_t*)(data + header.topologyOffset);
+}
+
+TrajectoryReader::~TrajectoryReader()
+{
+    if (data){
+        munmap((void*)data, size);
+    }
+}
+
+void TrajectoryReader::Topology(Robot &robot) const
+{
+    robot.masses.assign(header.massCount, PointMass());
+    const float* positions = Frames() > 0 ? Positions(0) : NULL;
+    for (int m=0; m<header.massCount; m++){
+        robot.masses[m].ID = m;
+        robot.masses[m].position.assign(3, 0.0f);
+        if (positions){
+            robot.masses[m].position.assign(positions + 3*m, positions + 3*m+3);
+        }
+    }
+    robot.springs.assign(header.springCount, Spring());
+    for (int i=0; i<header.springCount; i++){
+        robot.springs[i].m0 = M0(i);
+        robot.springs[i].m1 = M1(i);
+        robot.springs[i].original_L0 = RestLength(i);
+        robot.springs[i].L0 = RestLength(i);
+        robot.springs[i].ID = i;
+    }
+}
+
+float TrajectoryReader::RestLength(int spring) const
+{
+    float length;
+    memcpy(&length, &topology[3*spring+2], sizeof(float));
+    return length;
+}
+
+const char* TrajectoryReader::Column(long frame, uint64_t column, uint64_t frameBytes) const
+{
+    uint64_t chunk = frame/header.framesPerChunk;
+    uint64_t index = frame%header.framesPerChunk;
+    return data + header.chunkOffset + chunk*header.chunkBytes + column + index*frameBytes;
+}
+
+float TrajectoryReader::Time(long frame) const
+{
+    float time;
+    memcpy(&time, Column(frame, layout.time, sizeof(float)), sizeof(float));
+    return time;
+}
+
+const float* TrajectoryReader::Positions(long frame) const
+{
+    if (!(header.columns & TRAJECTORY_POSITIONS)){
+        return NULL;
+    }
+    return (const float*)Column(frame, layout.positions, header.massCount*3*sizeof(float));
+}
+
+const float* TrajectoryReader::Velocities(long frame) const
+{
+    if (!(header.columns & TRAJECTORY_VELOCITIES)){
+        return NULL;
+    }
+    return (const float*)Column(frame, layout.velocities, header.massCount*3*sizeof(float));
+}
+
+const float* TrajectoryReader::SpringLengths(long frame) const
+{
+    if (!(header.columns & TRAJECTORY_SPRING_LENGTHS)){
+        return NULL;
+    }
+    return (const float*)Column(frame, layout.springLengths, header.springCount*sizeof(float));
+}
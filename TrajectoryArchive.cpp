@@ -0,0 +1,512 @@
+//
+//  TrajectoryArchive.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/6/22.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "TrajectoryArchive.h"
+#include "Serialization.h"
+#include "Logger.h"
+using namespace std;
+
+static const char archive_magic[8] = {'P', 'S', 'A', 'R', 'C', 'H', 0, 0};
+
+//Rice codes longer than this are escaped and the value is written out in 32 bits
+static const int rice_limit = 24;
+
+//bits go in least significant first through a 64-bit accumulator
+class BitWriter
+{
+public:
+    std::vector<uint8_t> &bytes;
+    uint64_t bits;
+    int count;
+
+    BitWriter(std::vector<uint8_t> &bytes) : bytes(bytes), bits(0), count(0) {}
+
+    void Write(uint32_t value, int width)
+    {
+        bits |= (uint64_t)value << count;
+        count += width;
+        while (count >= 8){
+            bytes.push_back((uint8_t)bits);
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    void Flush()
+    {
+        if (count > 0){
+            bytes.push_back((uint8_t)bits);
+        }
+        bits = 0;
+        count = 0;
+    }
+};
+
+class BitReader
+{
+public:
+    BitReader(const uint8_t* data, size_t size) : data(data), end(data + size), bits(0), count(0) {}
+
+    //at least 57 valid bits after this (zeros past the end)
+    void Refill()
+    {
+        while (count <= 56){
+            uint64_t byte = data < end ? *data++ : 0;
+            bits |= byte << count;
+            count += 8;
+        }
+    }
+
+    uint32_t Peek() const { return (uint32_t)bits; }
+
+    void Skip(int width)
+    {
+        bits >>= width;
+        count -= width;
+    }
+
+    uint32_t Read(int width)
+    {
+        uint32_t value = (uint32_t)(bits & ((1ULL << width) - 1));
+        Skip(width);
+        return value;
+    }
+
+private:
+    const uint8_t* data;
+    const uint8_t* end;
+    uint64_t bits;
+    int count;
+};
+
+//LOCO-I style parameter: the smallest k with count*2^k >= sum of recent magnitudes
+struct RiceState{
+    uint32_t sum;
+    uint32_t count;
+
+    void Reset(uint32_t mean) { sum = mean*2; count = 2; }
+
+    int K() const
+    {
+        int k = 0;
+        while ((count << k) < sum && k < rice_limit-1){
+            k++;
+        }
+        return k;
+    }
+
+    void Update(uint32_t value)
+    {
+        sum += min(value, 1u << 20);
+        count++;
+        if (count >= 64){
+            sum >>= 1;
+            count >>= 1;
+        }
+    }
+};
+
+static void write_rice(BitWriter &out, RiceState &state, uint32_t value){
+    int k = state.K();
+    uint32_t quotient = value >> k;
+    if (quotient < rice_limit){
+        out.Write((1u << quotient) - 1, quotient + 1);
+        out.Write(value & ((1u << k) - 1), k);
+    }
+    else{
+        out.Write((1u << rice_limit) - 1, rice_limit);
+        out.Write(value & 0xffff, 16);
+        out.Write(value >> 16, 16);
+    }
+    state.Update(value);
+}
+
+static uint32_t read_rice(BitReader &in, RiceState &state){
+    int k = state.K();
+    in.Refill();
+    //the escape is exactly rice_limit ones, so never count further than that
+    int quotient = __builtin_ctz(~in.Peek() | (1u << rice_limit));
+    uint32_t value;
+    if (quotient < rice_limit){
+        in.Skip(quotient + 1);
+        value = (quotient << k) | in.Read(k);
+    }
+    else{
+        in.Skip(rice_limit);
+        value = in.Read(16);
+        in.Refill();
+        value |= in.Read(16) << 16;
+    }
+    state.Update(value);
+    return value;
+}
+
+static uint32_t zigzag(int32_t value){
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value){
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+//rounding to the grid is off by at most half a step, and turning origin + q*step back into a float adds
+//up to half an ulp of the largest coordinate; the step leaves room for both inside the bound
+static double quantum(float errorBound, const float* positions, size_t count){
+    float largest = 0;
+    for (size_t i=0; i<count; i++){
+        largest = max(largest, fabsf(positions[i]));
+    }
+    return 2.0*((double)errorBound - 2.0*largest*FLT_EPSILON);
+}
+
+//walks the entries of an archive image and keeps the ones whose header, checksum and tables hold up.
+//A torn or garbled entry is passed over by searching for the next magic, so the good entries after
+//it stay reachable. Returns the end of the last good entry, which is where the next append belongs
+static size_t scan_archive(const char* filename, const char* data, size_t size, vector<size_t> &entries, vector<ArchiveEntryHeader> &headers)
+{
+    size_t end = 0;
+    size_t offset = 0;
+    while (offset + sizeof(ArchiveEntryHeader) <= size){
+        //entries are packed back to back, so the header is copied out rather than read in place
+        ArchiveEntryHeader header;
+        memcpy(&header, data + offset, sizeof(header));
+        bool whole = memcmp(header.magic, archive_magic, sizeof(archive_magic)) == 0 && header.version == ARCHIVE_VERSION && header.entryBytes >= sizeof(header) && header.entryBytes <= size - offset;
+        if (!whole || fnv1a(data + offset + sizeof(header), header.entryBytes - sizeof(header)) != header.checksum){
+            LOG_WARN("Archive " << filename << " has an unreadable entry at byte " << offset);
+            const void* next = memmem(data + offset + 1, size - offset - 1, archive_magic, sizeof(archive_magic));
+            if (next == NULL){
+                break;
+            }
+            offset = (const char*)next - data;
+            continue;
+        }
+        //the spring table and key offsets must fit in the payload before Topology and Decode index them
+        uint64_t payloadBytes = header.entryBytes - sizeof(header);
+        uint64_t tables = 12*(uint64_t)header.springCount + sizeof(uint64_t)*(uint64_t)header.keyCount;
+        bool keys = header.framesPerKey > 0 && header.keyCount == (header.frameCount + (uint64_t)header.framesPerKey - 1)/header.framesPerKey;
+        if (!keys || tables > payloadBytes){
+            LOG_WARN("Archive " << filename << " skips a corrupt entry at byte " << offset);
+        }
+        else{
+            entries.push_back(offset);
+            headers.push_back(header);
+        }
+        offset += header.entryBytes;
+        end = offset;
+    }
+    return end;
+}
+
+ArchiveWriter::ArchiveWriter(const char* filename, float errorBound, int framesPerKey)
+{
+    ArchiveWriter::errorBound = errorBound;
+    ArchiveWriter::framesPerKey = max(framesPerKey, 1);
+    file = NULL;
+    int fd = open(filename, O_RDWR | O_CREAT | O_APPEND, 0644);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0){
+        LOG_ERROR("Could not open archive " << filename);
+        if (fd >= 0){
+            close(fd);
+        }
+        return;
+    }
+    //a crash mid-append leaves a torn entry at the end; cut it off so the new entry follows the last good one
+    if (info.st_size > 0){
+        void* mapped = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED){
+            LOG_ERROR("Could not map archive " << filename);
+            close(fd);
+            return;
+        }
+        vector<size_t> entries;
+        vector<ArchiveEntryHeader> headers;
+        size_t end = scan_archive(filename, (const char*)mapped, info.st_size, entries, headers);
+        munmap(mapped, info.st_size);
+        if (end < (size_t)info.st_size){
+            LOG_WARN("Archive " << filename << " drops " << info.st_size - end << " torn bytes at its end");
+            if (ftruncate(fd, end) != 0){
+                LOG_ERROR("Could not truncate archive " << filename);
+                close(fd);
+                return;
+            }
+        }
+    }
+    file = fdopen(fd, "ab");
+    if (file == NULL){
+        LOG_ERROR("Could not open archive " << filename);
+        close(fd);
+    }
+}
+
+ArchiveWriter::~ArchiveWriter()
+{
+    Close();
+}
+
+void ArchiveWriter::Close()
+{
+    if (file){
+        fclose(file);
+        file = NULL;
+    }
+}
+
+//one chunk of frames [first, last): the key frame's values, then each frame's difference from a prediction;
+//order 1 predicts the previous frame, order 2 extrapolates the last two (better for finely sampled runs)
+static void encode_chunk(vector<uint8_t> &payload, const float* positions, int values, int first, int last, const float origin[3], double step, int order){
+    vector<int32_t> previous(values);
+    vector<int32_t> older(values);
+    RiceState states[3];
+    BitWriter out(payload);
+    for (int axis=0; axis<3; axis++){
+        states[axis].Reset(1u << 12);
+    }
+    for (int f=first; f<last; f++){
+        const float* frame = positions + (size_t)f*values;
+        for (int v=0; v<values; v++){
+            int32_t q = (int32_t)lround((frame[v] - origin[v%3])/step);
+            int32_t predicted = 0;
+            if (f > first){
+                predicted = order == 2 && f-first >= 2 ? 2*previous[v] - older[v] : previous[v];
+            }
+            write_rice(out, states[v%3], zigzag(q - predicted));
+            older[v] = previous[v];
+            previous[v] = q;
+        }
+        if (f == first){
+            //the differences that follow are far smaller than the key frame values
+            for (int axis=0; axis<3; axis++){
+                states[axis].Reset(4);
+            }
+        }
+    }
+    out.Flush();
+}
+
+size_t ArchiveWriter::Append(long generation, long member, const Robot &robot, const float* positions, int frames, float frameDuration)
+{
+    if (file == NULL){
+        return 0;
+    }
+    int values = 3*(int)robot.masses.size();
+    int keys = (frames + framesPerKey - 1)/framesPerKey;
+    double step = quantum(errorBound, positions, (size_t)frames*values);
+    if (step <= 0){
+        LOG_ERROR("An error bound of " << errorBound << " is below float precision for this trajectory");
+        return 0;
+    }
+
+    //topology: m0, m1, rest length per spring
+    vector<uint8_t> payload;
+    for (int i=0; i<robot.springs.size(); i++){
+        const Spring &spring = robot.springs[i];
+        int32_t ends[2] = {spring.m0, spring.m1};
+        payload.insert(payload.end(), (const uint8_t*)ends, (const uint8_t*)ends + sizeof(ends));
+        payload.insert(payload.end(), (const uint8_t*)&spring.original_L0, (const uint8_t*)&spring.original_L0 + sizeof(float));
+    }
+    size_t table = payload.size();
+    payload.resize(table + keys*sizeof(uint64_t));
+
+    //every chunk: origin (3 floats), predictor order (1 byte), bits
+    vector<uint8_t> first;
+    vector<uint8_t> second;
+    for (int key=0; key<keys; key++){
+        uint64_t offset = payload.size();
+        memcpy(&payload[table + key*sizeof(uint64_t)], &offset, sizeof(offset));
+
+        //anchored at the key frame's bounding box corner, so its values are small and non-negative
+        int begin = key*framesPerKey;
+        int end = min(frames, begin + framesPerKey);
+        const float* frame = positions + (size_t)begin*values;
+        float origin[3] = {frame[0], frame[1], frame[2]};
+        for (int v=0; v<values; v++){
+            origin[v%3] = min(origin[v%3], frame[v]);
+        }
+        payload.insert(payload.end(), (const uint8_t*)origin, (const uint8_t*)origin + sizeof(origin));
+
+        first.clear();
+        second.clear();
+        encode_chunk(first, positions, values, begin, end, origin, step, 1);
+        encode_chunk(second, positions, values, begin, end, origin, step, 2);
+        bool useSecond = second.size() < first.size();
+        payload.push_back(useSecond ? 2 : 1);
+        const vector<uint8_t> &bits = useSecond ? second : first;
+        payload.insert(payload.end(), bits.begin(), bits.end());
+    }
+
+    ArchiveEntryHeader header;
+    memcpy(header.magic, archive_magic, sizeof(header.magic));
+    header.version = ARCHIVE_VERSION;
+    header.massCount = (uint32_t)robot.masses.size();
+    header.springCount = (uint32_t)robot.springs.size();
+    header.frameCount = frames;
+    header.framesPerKey = framesPerKey;
+    header.keyCount = keys;
+    header.generation = generation;
+    header.member = member;
+    header.frameDuration = frameDuration;
+    header.errorBound = errorBound;
+    header.quantum = step;
+    header.entryBytes = sizeof(header) + payload.size();
+    header.checksum = fnv1a((const char*)payload.data(), payload.size());
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+    ok = fflush(file) == 0 && ok;
+    if (!ok){
+        LOG_ERROR("Could not append to archive");
+        return 0;
+    }
+    return header.entryBytes;
+}
+
+ArchiveReader::ArchiveReader(const char* filename)
+{
+    data = NULL;
+    size = 0;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0){
+        LOG_ERROR("Could not open archive " << filename);
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(ArchiveEntryHeader)){
+        LOG_ERROR(filename << " is not an archive");
+        close(fd);
+        return;
+    }
+    void* mapped = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED){
+        LOG_ERROR("Could not map archive " << filename);
+        return;
+    }
+    data = (const char*)mapped;
+    size = info.st_size;
+
+    scan_archive(filename, data, size, entries, headers);
+}
+
+ArchiveReader::~ArchiveReader()
+{
+    if (data){
+        munmap((void*)data, size);
+    }
+}
+
+void ArchiveReader::Topology(int entry, Robot &robot) const
+{
+    const ArchiveEntryHeader &header = Entry(entry);
+    const char* springs = data + entries[entry] + sizeof(header);
+    robot.masses.assign(header.massCount, PointMass());
+    vector<float> first(3*header.massCount);
+    if (header.frameCount > 0){
+        Decode(entry, 0, 1, first.data());
+    }
+    for (int m=0; m<header.massCount; m++){
+        PointMass &mass = robot.masses[m];
+        mass.position = {first[3*m+0], first[3*m+1], first[3*m+2]};
+        mass.velocity = {0, 0, 0};
+        mass.acceleration = {0, 0, 0};
+        mass.forces = {0, 0, 0};
+        mass.ID = m;
+    }
+    robot.springs.resize(header.springCount);
+    for (int i=0; i<header.springCount; i++){
+        int32_t ends[2];
+        float length;
+        memcpy(ends, springs + 12*i, sizeof(ends));
+        memcpy(&length, springs + 12*i + 8, sizeof(length));
+        Spring &spring = robot.springs[i];
+        spring.m0 = ends[0];
+        spring.m1 = ends[1];
+        spring.L0 = length;
+        spring.L = length;
+        spring.original_L0 = length;
+        spring.k = spring_constant;
+        spring.ID = i;
+    }
+}
+
+bool ArchiveReader::Decode(int entry, long first, long count, float* out) const
+{
+    const ArchiveEntryHeader &header = Entry(entry);
+    if (first < 0 || count < 0 || first + count > header.frameCount){
+        LOG_ERROR("Frames " << first << "+" << count << " are outside entry " << entry);
+        return false;
+    }
+    const uint8_t* payload = (const uint8_t*)(data + entries[entry] + sizeof(header));
+    size_t payloadBytes = header.entryBytes - sizeof(header);
+    size_t table = 12*(size_t)header.springCount;
+    int values = 3*header.massCount;
+    double step = header.quantum;
+
+    vector<int32_t> current(values);
+    vector<int32_t> older(values);
+    RiceState states[3];
+    long f = first - first%header.framesPerKey;
+    while (f < first + count){
+        uint32_t key = (uint32_t)(f/header.framesPerKey);
+        uint64_t offset;
+        memcpy(&offset, payload + table + key*sizeof(uint64_t), sizeof(offset));
+        uint64_t end = payloadBytes;
+        if (key+1 < header.keyCount){
+            memcpy(&end, payload + table + (key+1)*sizeof(uint64_t), sizeof(end));
+        }
+        if (offset + 13 > end || end > payloadBytes){
+            LOG_ERROR("Archive entry " << entry << " is corrupt");
+            return false;
+        }
+        float origin[3];
+        memcpy(origin, payload + offset, sizeof(origin));
+        int order = payload[offset + 12];
+        BitReader in(payload + offset + 13, end - offset - 13);
+        for (int axis=0; axis<3; axis++){
+            states[axis].Reset(1u << 12);
+        }
+
+        long begin = f;
+        long last = min((long)header.frameCount, begin + header.framesPerKey);
+        for (; f<last && f<first+count; f++){
+            for (int v=0; v<values; v++){
+                int32_t residual = unzigzag(read_rice(in, states[v%3]));
+                int32_t predicted = 0;
+                if (f > begin){
+                    predicted = order == 2 && f-begin >= 2 ? 2*current[v] - older[v] : current[v];
+                }
+                older[v] = current[v];
+                current[v] = predicted + residual;
+            }
+            if (f == begin){
+                for (int axis=0; axis<3; axis++){
+                    states[axis].Reset(4);
+                }
+            }
+            if (f >= first){
+                float* frame = out + (size_t)(f-first)*values;
+                for (int v=0; v<values; v++){
+                    frame[v] = (float)(origin[v%3] + current[v]*step);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool ArchiveReader::Decode(int entry, vector<float> &positions) const
+{
+    const ArchiveEntryHeader &header = Entry(entry);
+    positions.resize((size_t)header.frameCount*3*header.massCount);
+    return Decode(entry, 0, header.frameCount, positions.data());
+}
@@ -0,0 +1,92 @@
+//
+//  TrajectoryPack.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 1/6/22.
+//
+//  Appends the positions of a recorded trajectory to a compressed archive, then reads the entry
+//  back and reports the compression ratio, the largest error and how much faster than real time
+//  it decodes.
+//  Usage: TrajectoryPack <trajectory> <archive> [error bound] [generation] [member]
+//  e.g.   TrajectoryPack best.traj elites.psa 1e-4 12 0
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#include "Robot.h"
+#include "Trajectory.h"
+#include "TrajectoryArchive.h"
+#include "Logger.h"
+using namespace std;
+
+static double seconds_since(chrono::steady_clock::time_point start){
+    return chrono::duration<double>(chrono::steady_clock::now()-start).count();
+}
+
+int main(int argc, const char * argv[]) {
+    if (argc < 3){
+        fprintf(stderr, "Usage: TrajectoryPack <trajectory> <archive> [error bound] [generation] [member]\n");
+        return 1;
+    }
+    float errorBound = argc > 3 ? atof(argv[3]) : 1e-4f;
+    long generation = argc > 4 ? atol(argv[4]) : 0;
+    long member = argc > 5 ? atol(argv[5]) : 0;
+
+    TrajectoryReader trajectory(argv[1]);
+    if (!trajectory.IsOpen() || trajectory.Frames() == 0 || trajectory.Positions(0) == NULL){
+        LOG_ERROR(argv[1] << " has no positions to pack");
+        return 1;
+    }
+    Robot robot;
+    trajectory.Topology(robot);
+    int frames = (int)trajectory.Frames();
+    size_t values = 3*robot.masses.size();
+    vector<float> positions(frames*values);
+    for (int f=0; f<frames; f++){
+        memcpy(&positions[f*values], trajectory.Positions(f), values*sizeof(float));
+    }
+
+    ArchiveWriter writer(argv[2], errorBound);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    size_t bytes = writer.Append(generation, member, robot, positions.data(), frames, trajectory.FrameDuration());
+    double encodeTime = seconds_since(start);
+    writer.Close();
+    if (bytes == 0){
+        return 1;
+    }
+
+    //the entry just written is the last one with its generation, member and size; entries after a
+    //garbled stretch are still found, so it is not necessarily the last one parsed
+    ArchiveReader archive(argv[2]);
+    int entry = archive.Entries()-1;
+    while (entry >= 0 && (archive.Entry(entry).generation != generation || archive.Entry(entry).member != member || archive.Entry(entry).entryBytes != bytes)){
+        entry--;
+    }
+    if (entry < 0){
+        LOG_ERROR("The entry just appended to " << argv[2] << " cannot be read back");
+        return 1;
+    }
+    vector<float> decoded;
+    start = chrono::steady_clock::now();
+    bool ok = archive.Decode(entry, decoded);
+    double decodeTime = seconds_since(start);
+    if (!ok){
+        LOG_ERROR("Decoding entry " << entry << " of " << argv[2] << " failed");
+        return 1;
+    }
+    float maxError = 0;
+    for (size_t i=0; i<positions.size(); i++){
+        maxError = max(maxError, fabsf(decoded[i]-positions[i]));
+    }
+
+    double raw = positions.size()*sizeof(float);
+    double duration = frames*trajectory.FrameDuration();
+    fprintf(stderr, "%d frames, %zu masses: %.0f -> %zu bytes (%.1fx, %.2f bits/coordinate)\n", frames, robot.masses.size(), raw, bytes, raw/bytes, 8.0*bytes/positions.size());
+    fprintf(stderr, "max error %.3g (bound %.3g), encode %.0f frames/s, decode %.0f frames/s = %.0fx real time\n", maxError, errorBound, frames/encodeTime, frames/decodeTime, duration/decodeTime);
+    return maxError <= errorBound ? 0 : 1;
+}
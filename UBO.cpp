@@ -0,0 +1,42 @@
+//
+//  UBO.cpp
+//  PhysicsSimulator
+//
+//  Created by Albert Go on 12/5/21.
+//
+
+#include <stdio.h>
+#include "UBO.h"
+
+UBO::UBO(GLsizeiptr size, GLuint binding)
+{
+    capacity = size;
+    UBO::binding = binding;
+    glGenBuffers(1, &ID);
+    glBindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, ID);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UBO::Update(const void* data, GLsizeiptr size, GLintptr offset)
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UBO::Bind()
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, ID);
+}
+
+void UBO::Unbind()
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UBO::Delete()
+{
+    glDeleteBuffers(1, &ID);
+}
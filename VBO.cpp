@@ -10,11 +10,32 @@
 
 VBO::VBO(GLfloat* vertices, GLsizeiptr size)
 {
+    capacity = size;
+    usage = GL_STATIC_DRAW;
     glGenBuffers(1, &ID);
     glBindBuffer(GL_ARRAY_BUFFER, ID);
     glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
 }
 
+VBO::VBO(GLsizeiptr size, GLenum usage)
+{
+    capacity = size;
+    VBO::usage = usage;
+    glGenBuffers(1, &ID);
+    glBindBuffer(GL_ARRAY_BUFFER, ID);
+    glBufferData(GL_ARRAY_BUFFER, size, NULL, usage);
+}
+
+void VBO::Update(GLfloat* vertices, GLsizeiptr size, GLintptr offset)
+{
+    glBufferSubData(GL_ARRAY_BUFFER, offset, size, vertices);
+}
+
+void VBO::Orphan()
+{
+    glBufferData(GL_ARRAY_BUFFER, capacity, NULL, usage);
+}
+
 void VBO::Bind()
 {
     glBindBuffer(GL_ARRAY_BUFFER, ID);
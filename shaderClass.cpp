@@ -6,12 +6,19 @@
 //
 
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <vector>
 #include "shaderClass.h"
+#include "Logger.h"
+#include <glm/gtc/type_ptr.hpp>
 
 std::string get_file_contents(const char* filename)
 {
     std::ifstream in(filename, std::ios::binary);
-    std::cout<< filename << std::endl;
+    LOG_DEBUG("Loading shader " << filename);
     if(in)
     {
         std::string contents;
@@ -25,30 +32,319 @@ std::string get_file_contents(const char* filename)
     throw(errno);
 }
 
+static const char* shader_cache_dir = "ShaderCache";
+static const uint32_t shader_cache_magic = 0x42505350; // "PSPB"
+
+static std::pair<long, long> file_stamp(const std::string &filename)
+{
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0){
+        return std::make_pair(-1L, -1L);
+    }
+    return std::make_pair((long)info.st_mtime, (long)info.st_size);
+}
+
+//glGetProgramBinary is GL 4.1, so on a plain 3.3 context the entry points are not loaded
+static bool program_binaries_supported()
+{
+    if (glGetProgramBinary == NULL || glProgramBinary == NULL || glProgramParameteri == NULL){
+        return false;
+    }
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+//FNV-1a over both sources and the driver strings, since a binary only loads on the driver that wrote it
+static uint64_t program_key(const std::string &vertexCode, const std::string &fragmentCode)
+{
+    std::string driver;
+    GLenum names[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+    for (int n=0; n<3; n++){
+        const GLubyte* name = glGetString(names[n]);
+        if (name){
+            driver += (const char*)name;
+        }
+    }
+    
+    uint64_t hash = 1469598103934665603ULL;
+    const std::string* parts[] = {&vertexCode, &fragmentCode, &driver};
+    for (int p=0; p<3; p++){
+        for (size_t i=0; i<parts[p]->size(); i++){
+            hash ^= (unsigned char)(*parts[p])[i];
+            hash *= 1099511628211ULL;
+        }
+        //separator, so moving text from one file to the other changes the key
+        hash ^= 0xff;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static std::string cache_path(uint64_t key)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "%s/%016llx.bin", shader_cache_dir, (unsigned long long)key);
+    return name;
+}
+
+//0 when there is no usable binary for key
+static GLuint load_cached_program(uint64_t key)
+{
+    FILE* file = fopen(cache_path(key).c_str(), "rb");
+    if (file == NULL){
+        return 0;
+    }
+    uint32_t header[3]; // magic, binary format, length
+    std::vector<char> binary;
+    bool ok = fread(header, sizeof(header), 1, file) == 1 && header[0] == shader_cache_magic;
+    if (ok){
+        binary.resize(header[2]);
+        ok = fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+    fclose(file);
+    if (!ok){
+        return 0;
+    }
+    
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, (GLenum)header[1], binary.data(), (GLsizei)binary.size());
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE){
+        //the driver changed since the binary was written; compile from source instead
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+static void save_cached_program(GLuint program, uint64_t key)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0){
+        return;
+    }
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    
+    mkdir(shader_cache_dir, 0755);
+    FILE* file = fopen(cache_path(key).c_str(), "wb");
+    if (file == NULL){
+        LOG_WARN("Could not write the shader cache in " << shader_cache_dir);
+        return;
+    }
+    uint32_t header[3] = {shader_cache_magic, (uint32_t)format, (uint32_t)length};
+    fwrite(header, sizeof(header), 1, file);
+    fwrite(binary.data(), 1, length, file);
+    fclose(file);
+}
+
+//0 (after logging the compiler output) when the source does not compile
+static GLuint compile_shader(GLenum type, const std::string &code, const std::string &filename)
+{
+    const char* source = code.c_str();
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (compiled != GL_TRUE){
+        GLint length = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        std::string log(std::max(length, 1), '\0');
+        glGetShaderInfoLog(shader, (GLsizei)log.size(), NULL, &log[0]);
+        LOG_ERROR("Failed to compile " << filename << ":\n" << log.c_str());
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+//0 (after logging why) when the program does not build
+static GLuint build_program(const std::string &vertexCode, const std::string &fragmentCode, const std::string &vertexFile, const std::string &fragmentFile)
+{
+    bool cache = program_binaries_supported();
+    uint64_t key = 0;
+    if (cache){
+        key = program_key(vertexCode, fragmentCode);
+        GLuint program = load_cached_program(key);
+        if (program){
+            LOG_DEBUG("Loaded " << vertexFile << " + " << fragmentFile << " from " << cache_path(key));
+            return program;
+        }
+    }
+    
+    GLuint vertexShader = compile_shader(GL_VERTEX_SHADER, vertexCode, vertexFile);
+    GLuint fragmentShader = compile_shader(GL_FRAGMENT_SHADER, fragmentCode, fragmentFile);
+    if (vertexShader == 0 || fragmentShader == 0){
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return 0;
+    }
+    
+    GLuint program = glCreateProgram();
+    if (cache){
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE){
+        GLint length = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::string log(std::max(length, 1), '\0');
+        glGetProgramInfoLog(program, (GLsizei)log.size(), NULL, &log[0]);
+        LOG_ERROR("Failed to link " << vertexFile << " + " << fragmentFile << ":\n" << log.c_str());
+        glDeleteProgram(program);
+        return 0;
+    }
+    
+    if (cache){
+        save_cached_program(program, key);
+    }
+    return program;
+}
+
 Shader::Shader(const char* vertexFile, const char* fragmentFile)
 {
+    Shader::vertexFile = vertexFile;
+    Shader::fragmentFile = fragmentFile;
+    vertexStamp = file_stamp(vertexFile);
+    fragmentStamp = file_stamp(fragmentFile);
+    
     std::string vertexCode = get_file_contents(vertexFile);
     std::string fragmentCode = get_file_contents(fragmentFile);
     
-    const char* vertexSource = vertexCode.c_str();
-    const char* fragmentSource = fragmentCode.c_str();
+    ID = build_program(vertexCode, fragmentCode, vertexFile, fragmentFile);
     
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexSource, NULL);
-    glCompileShader(vertexShader);
+    CacheUniforms();
+}
+
+bool Shader::Reload()
+{
+    vertexStamp = file_stamp(vertexFile);
+    fragmentStamp = file_stamp(fragmentFile);
     
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
-    glCompileShader(fragmentShader);
+    std::string vertexCode;
+    std::string fragmentCode;
+    try
+    {
+        vertexCode = get_file_contents(vertexFile.c_str());
+        fragmentCode = get_file_contents(fragmentFile.c_str());
+    }
+    catch (int error)
+    {
+        LOG_ERROR("Could not reload " << vertexFile << " + " << fragmentFile << ": " << strerror(error));
+        return false;
+    }
     
-    ID = glCreateProgram();
+    GLuint program = build_program(vertexCode, fragmentCode, vertexFile, fragmentFile);
+    if (program == 0){
+        if (ID != 0){
+            LOG_WARN("Keeping the previous " << vertexFile << " + " << fragmentFile << " program");
+        }
+        return false;
+    }
     
-    glAttachShader(ID, vertexShader);
-    glAttachShader(ID, fragmentShader);
-    glLinkProgram(ID);
+    if (ID != 0){
+        glDeleteProgram(ID);
+    }
+    ID = program;
+    CacheUniforms();
+    for (std::map<std::string, GLuint>::iterator it = blockBindings.begin(); it != blockBindings.end(); it++){
+        BindUniformBlock(it->first.c_str(), it->second);
+    }
+    LOG_INFO("Reloaded " << vertexFile << " + " << fragmentFile);
+    return true;
+}
+
+bool Shader::ReloadIfChanged()
+{
+    if (file_stamp(vertexFile) == vertexStamp && file_stamp(fragmentFile) == fragmentStamp){
+        return false;
+    }
+    return Reload();
+}
+
+void Shader::CacheUniforms()
+{
+    uniforms.clear();
+    if (ID == 0){
+        return;
+    }
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
     
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    std::string name(maxLength, '\0');
+    for (GLint i=0; i<count; i++){
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, (GLuint)i, maxLength, &length, &size, &type, &name[0]);
+        std::string key = name.substr(0, length);
+        
+        //arrays are reported as "name[0]"; look them up by their plain name
+        size_t bracket = key.find('[');
+        if (bracket != std::string::npos){
+            key = key.substr(0, bracket);
+        }
+        
+        GLint location = glGetUniformLocation(ID, key.c_str());
+        if (location >= 0){
+            uniforms[key] = location;
+        }
+    }
+    LOG_DEBUG("Program " << ID << " has " << uniforms.size() << " uniforms");
+}
+
+GLint Shader::UniformLocation(const std::string &name) const
+{
+    std::unordered_map<std::string, GLint>::const_iterator it = uniforms.find(name);
+    if (it == uniforms.end()){
+        return -1;
+    }
+    return it->second;
+}
+
+void Shader::setMat4(const std::string &name, const glm::mat4 &value) const
+{
+    glUniformMatrix4fv(UniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::setFloat(const std::string &name, float value) const
+{
+    glUniform1f(UniformLocation(name), value);
+}
+
+void Shader::setInt(const std::string &name, int value) const
+{
+    glUniform1i(UniformLocation(name), value);
+}
+
+void Shader::BindUniformBlock(const char* name, GLuint binding)
+{
+    blockBindings[name] = binding;
+    if (ID == 0){
+        return;
+    }
+    GLuint index = glGetUniformBlockIndex(ID, name);
+    if (index == GL_INVALID_INDEX){
+        LOG_WARN("Program " << ID << " has no uniform block " << name);
+        return;
+    }
+    glUniformBlockBinding(ID, index, binding);
 }
 
 void Shader::Activate()